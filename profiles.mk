@@ -0,0 +1,31 @@
+#*******************************************************************************
+#   Taras Shchybovyk
+#   (c) 2020 Andrew Chaney
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+#*******************************************************************************
+
+# Memory profile: operation staging buffer, argument buffer, list builders, templates
+# and cached signatures. Shared by the app and the host build (test/host), keyed on
+# TARGET_NAME as the SDK sets it.
+ifeq ($(TARGET_NAME),TARGET_NANOX)
+DEFINES   += HIVE_OP_BUFFER_SIZE=1536 HIVE_ARG_DATA_SIZE=256 HIVE_LIST_BUFFER_SIZE=256
+DEFINES   += HIVE_OP_STAGING_SLOTS=2 HIVE_PARSER_RAM_BUDGET=4096
+DEFINES   += HIVE_TEMPLATE_SLOTS=4 HIVE_TEMPLATE_SIZE=1024 HIVE_SIGNATURE_CACHE_SLOTS=8
+else
+DEFINES   += HIVE_OP_BUFFER_SIZE=640 HIVE_ARG_DATA_SIZE=128 HIVE_LIST_BUFFER_SIZE=128
+DEFINES   += HIVE_PARSER_RAM_BUDGET=1024
+# no room for templates or cached signatures: INS_LOAD_TEMPLATE and
+# INS_SIGN_TEMPLATE answer 0x6D00, P2_RETRY is refused
+DEFINES   += HIVE_TEMPLATE_SLOTS=0 HIVE_SIGNATURE_CACHE_SLOTS=0
+endif
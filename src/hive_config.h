@@ -0,0 +1,91 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HIVE_CONFIG_H__
+#define __HIVE_CONFIG_H__
+
+/**
+ * Per-target memory profile.
+ * profiles.mk selects the sizes for each TARGET_NAME, for the app and the host
+ * build. The values below are the Nano S profile and are only used when nothing
+ * was provided.
+ *
+ * HIVE_OP_BUFFER_SIZE    - staging buffer for a single serialized operation
+ * HIVE_ARG_DATA_SIZE     - rendered value of a single argument (screen text)
+ * HIVE_LIST_BUFFER_SIZE  - builder used for authority, beneficiary and id lists
+ * HIVE_OP_NAME_SIZE      - operation name shown on the review screen
+ * HIVE_SCRATCH_TEMP_SIZE - largest helper temporary taken from the scratch arena
+ * HIVE_PARSER_RAM_BUDGET - upper bound for the whole parser state
+ * HIVE_OP_STAGING_SLOTS  - 2 lets the next operation stream in while one is reviewed
+ * HIVE_TEMPLATE_SLOTS    - transaction templates kept for the session, 0 leaves them out
+ * HIVE_TEMPLATE_SIZE     - encoded size of a single template
+ * HIVE_SIGNATURE_CACHE_SLOTS - signatures kept to answer a retried transaction, 0 leaves
+ *                          P2_RETRY out
+*/
+
+#ifndef HIVE_OP_BUFFER_SIZE
+#define HIVE_OP_BUFFER_SIZE 640
+#endif
+
+#ifndef HIVE_ARG_DATA_SIZE
+#define HIVE_ARG_DATA_SIZE 128
+#endif
+
+#ifndef HIVE_LIST_BUFFER_SIZE
+#define HIVE_LIST_BUFFER_SIZE 128
+#endif
+
+#ifndef HIVE_OP_NAME_SIZE
+#define HIVE_OP_NAME_SIZE 32
+#endif
+
+// Largest nested helper temporary, the append() working buffer
+// (b58enc needs at most 52 bytes for a public key)
+#ifndef HIVE_SCRATCH_TEMP_SIZE
+#define HIVE_SCRATCH_TEMP_SIZE 100
+#endif
+
+#define HIVE_SCRATCH_SIZE (HIVE_LIST_BUFFER_SIZE + HIVE_SCRATCH_TEMP_SIZE)
+
+#ifndef HIVE_OP_STAGING_SLOTS
+#define HIVE_OP_STAGING_SLOTS 1
+#endif
+
+#ifndef HIVE_TEMPLATE_SLOTS
+#define HIVE_TEMPLATE_SLOTS 1
+#endif
+
+#ifndef HIVE_TEMPLATE_SIZE
+#define HIVE_TEMPLATE_SIZE 256
+#endif
+
+#ifndef HIVE_SIGNATURE_CACHE_SLOTS
+#define HIVE_SIGNATURE_CACHE_SLOTS 2
+#endif
+
+#ifndef HIVE_PARSER_RAM_BUDGET
+#define HIVE_PARSER_RAM_BUDGET 1024
+#endif
+
+// List builders are copied into the argument buffer once rendered
+_Static_assert(HIVE_LIST_BUFFER_SIZE <= HIVE_ARG_DATA_SIZE, "list builder does not fit the argument buffer");
+// Longest operation name is "cancel_transfer_from_savings"
+_Static_assert(HIVE_OP_NAME_SIZE >= 29, "operation name buffer too small");
+// Scratch allocations are word aligned
+_Static_assert(HIVE_LIST_BUFFER_SIZE % 4 == 0 && HIVE_SCRATCH_TEMP_SIZE % 4 == 0, "scratch sizes must be word aligned");
+
+#endif // __HIVE_CONFIG_H__
@@ -34,6 +34,17 @@ void printString(const char in[], const char fieldName[], actionArgument_t *arg)
     os_memmove(arg->data, in, inLength);
 }
 
+/**
+ * Read a single byte (list size, flag) of the operation data.
+*/
+uint8_t readUint8(uint8_t *in, uint32_t inLength) {
+    if (inLength < sizeof(uint8_t)) {
+        PRINTF("readUint8 Insufficient buffer\n");
+        THROW(EXCEPTION);
+    }
+    return in[0];
+}
+
 void parsePublicKeyField(uint8_t *in, uint32_t inLength, const char fieldName[], actionArgument_t *arg, uint32_t *read, uint32_t *written) {
     if (inLength < 33) {
         PRINTF("parseActionData Insufficient buffer\n");
@@ -190,7 +201,7 @@ void parseStringField(uint8_t *in, uint32_t inLength, const char fieldName[], ac
         THROW(EXCEPTION);
     } 
 
-    if (inLength < fieldLength) {
+    if (inLength - readFromBuffer < fieldLength) {
         PRINTF("parseActionData Insufficient buffer\n");
         THROW(EXCEPTION);
     }
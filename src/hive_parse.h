@@ -19,13 +19,15 @@
 #define __HIVE_PARSE_H__
 
 #include <stdint.h>
+#include "hive_config.h"
 
 typedef struct actionArgument_t {
     char label[32];
-    char data[128];
+    char data[HIVE_ARG_DATA_SIZE];
 } actionArgument_t;
 
 void printString(const char in[], const char fieldName[], actionArgument_t *arg);
+uint8_t readUint8(uint8_t *in, uint32_t inLength);
 void parsePublicKeyField(uint8_t *in, uint32_t inLength, const char fieldName[], actionArgument_t *arg, uint32_t *read, uint32_t *written);
 void parseUint16Field(uint8_t *in, uint32_t inLength, const char fieldName[], actionArgument_t *arg, uint32_t *read, uint32_t *written);
 void parseUint32Field(uint8_t *in, uint32_t inLength, const char fieldName[], actionArgument_t *arg, uint32_t *read, uint32_t *written);
@@ -17,6 +17,7 @@
 
 #include "hive_parse_operations.h"
 #include "hive_types.h"
+#include "hive_scratch.h"
 #include <string.h>
 #include "os.h"
 
@@ -24,7 +25,7 @@ void parseHiveVote(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actio
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Voter", arg, &read, &written);
     if (argNum == 0) return;
@@ -45,7 +46,7 @@ void parseHiveComment(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, ac
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Parent Author", arg, &read, &written);
     if (argNum == 0) return;
@@ -78,7 +79,7 @@ void parseHiveTransfer(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, a
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "From", arg, &read, &written);
     if (argNum == 0) return;
@@ -88,7 +89,7 @@ void parseHiveTransfer(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, a
     if (argNum == 1) return;
 
     buffer += read; bufferLength -= read;
-    parseAssetField(buffer, sizeof(asset_t), "Amount", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Amount", arg, &read, &written);
     if (argNum == 2) return;
 
     buffer += read; bufferLength -= read;
@@ -99,7 +100,7 @@ void parseHiveTransferToVesting(uint8_t *buffer, uint32_t bufferLength, uint8_t
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "From", arg, &read, &written);
     if (argNum == 0) return;
@@ -109,27 +110,27 @@ void parseHiveTransferToVesting(uint8_t *buffer, uint32_t bufferLength, uint8_t
     if (argNum == 1) return;
 
     buffer += read; bufferLength -= read;
-    parseAssetField(buffer, sizeof(asset_t), "Amount", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Amount", arg, &read, &written);
 }
 
 void parseHiveWithdrawVesting(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Account", arg, &read, &written);
     if (argNum == 0) return;
 
     buffer += read; bufferLength -= read;
-    parseAssetField(buffer, sizeof(asset_t), "Vesting Shares", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Vesting Shares", arg, &read, &written);
 }
 
 void parseHiveLimitOrderCreate(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Owner", arg, &read, &written);
     if (argNum == 0) return;
@@ -139,18 +140,18 @@ void parseHiveLimitOrderCreate(uint8_t *buffer, uint32_t bufferLength, uint8_t a
     if (argNum == 1) return;
 
     buffer += sizeof(uint32_t); bufferLength -= sizeof(uint32_t);
-    parseAssetField(buffer, sizeof(asset_t), "Amount To Sell", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Amount To Sell", arg, &read, &written);
     if (argNum == 2) return;
 
     buffer += read; bufferLength -= read;
-    parseAssetField(buffer, sizeof(asset_t), "Min To Receive", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Min To Receive", arg, &read, &written);
     if (argNum == 3) return;
 
     buffer += read; bufferLength -= read;
-    printString(buffer[0] == 0x01 ? "true" : "false", "Fill or Kill", arg);
+    printString(readUint8(buffer, bufferLength) == 0x01 ? "true" : "false", "Fill or Kill", arg);
     if (argNum == 4) return;
 
-    buffer += read; bufferLength -= read;
+    buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
     parseUint32Field(buffer, bufferLength, "Expiration", arg, &read, &written);
 }
 
@@ -158,7 +159,7 @@ void parseHiveLimitOrderCancel(uint8_t *buffer, uint32_t bufferLength, uint8_t a
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Owner", arg, &read, &written);
     if (argNum == 0) return;
@@ -171,7 +172,7 @@ void parseHiveFeedPublish(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Publisher", arg, &read, &written);
     if (argNum == 0) return;
@@ -188,7 +189,7 @@ void parseHiveConvert(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, ac
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Owner", arg, &read, &written);
     if (argNum == 0) return;
@@ -198,144 +199,145 @@ void parseHiveConvert(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, ac
     if (argNum == 1) return;
 
     buffer += read; bufferLength -= read;
-    parseAssetField(buffer, sizeof(asset_t), "Amount", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Amount", arg, &read, &written);
 }
 
 void parseHiveAccountCreate(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
-    parseAssetField(buffer, sizeof(asset_t), "Amount", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Amount", arg, &read, &written);
     if (argNum == 0) return;
 
     buffer += read; bufferLength -= read;
-    parseStringField(buffer, sizeof(asset_t), "Creator", arg, &read, &written);
+    parseStringField(buffer, bufferLength, "Creator", arg, &read, &written);
     if (argNum == 1) return;
 
     buffer += read; bufferLength -= read;
-    parseStringField(buffer, sizeof(asset_t), "New Account Name", arg, &read, &written);
+    parseStringField(buffer, bufferLength, "New Account Name", arg, &read, &written);
     if (argNum == 2) return;
 
-    char tmp[128];
+    buffer += read; bufferLength -= read;
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numOwnerAccountAuths = 0;
-    os_memmove(&numOwnerAccountAuths, buffer, sizeof(uint8_t));
+    numOwnerAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numOwnerAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numOwnerKeyAuths = 0;
-    os_memmove(&numOwnerKeyAuths, buffer, sizeof(uint8_t));
+    numOwnerKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numOwnerKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
-    if( argNum == 2) { // owner auth
+    if( argNum == 3) { // owner auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
-    os_memset(tmp, 0, sizeof(tmp));
+    os_memset(tmp, 0, HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numActiveAccountAuths = 0;
-    os_memmove(&numActiveAccountAuths, buffer, sizeof(uint8_t));
+    numActiveAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numActiveAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numActiveKeyAuths = 0;
-    os_memmove(&numActiveKeyAuths, buffer, sizeof(uint8_t));
+    numActiveKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numActiveKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
-    if( argNum == 3) { // active auth
+    if( argNum == 4) { // active auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
-    os_memset(tmp, 0, sizeof(tmp));
+    os_memset(tmp, 0, HIVE_LIST_BUFFER_SIZE);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     parseUint32Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numPostingAccountAuths = 0;
-    os_memmove(&numPostingAccountAuths, buffer, sizeof(uint8_t));
+    numPostingAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numPostingAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numPostingKeyAuths = 0;
-    os_memmove(&numPostingKeyAuths, buffer, sizeof(uint8_t));
+    numPostingKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numPostingKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
-    if( argNum == 4) { // posting auth
+    if( argNum == 5) { // posting auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
@@ -344,7 +346,7 @@ void parseHiveAccountCreate(uint8_t *buffer, uint32_t bufferLength, uint8_t argN
     parsePublicKeyField(buffer, bufferLength, "Memo Key", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    if( argNum == 5) return;
+    if( argNum == 6) return;
 
     os_memset(arg->data, 0, sizeof(arg->data));
 
@@ -355,129 +357,131 @@ void parseHiveAccountUpdate(uint8_t *buffer, uint32_t bufferLength, uint8_t argN
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
-    parseStringField(buffer, sizeof(asset_t), "Account", arg, &read, &written);
-    if (argNum == 2) return;
+    parseStringField(buffer, bufferLength, "Account", arg, &read, &written);
+    if (argNum == 0) return;
 
-    char tmp[128];
+    buffer += read; bufferLength -= read;
+
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numOwnerAccountAuths = 0;
-    os_memmove(&numOwnerAccountAuths, buffer, sizeof(uint8_t));
+    numOwnerAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numOwnerAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numOwnerKeyAuths = 0;
-    os_memmove(&numOwnerKeyAuths, buffer, sizeof(uint8_t));
+    numOwnerKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numOwnerKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
-    if( argNum == 2) { // owner auth
+    if( argNum == 1) { // owner auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
-    os_memset(tmp, 0, sizeof(tmp));
+    os_memset(tmp, 0, HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numActiveAccountAuths = 0;
-    os_memmove(&numActiveAccountAuths, buffer, sizeof(uint8_t));
+    numActiveAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numActiveAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numActiveKeyAuths = 0;
-    os_memmove(&numActiveKeyAuths, buffer, sizeof(uint8_t));
+    numActiveKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numActiveKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
-    if( argNum == 3) { // active auth
+    if( argNum == 2) { // active auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
-    os_memset(tmp, 0, sizeof(tmp));
+    os_memset(tmp, 0, HIVE_LIST_BUFFER_SIZE);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     parseUint32Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numPostingAccountAuths = 0;
-    os_memmove(&numPostingAccountAuths, buffer, sizeof(uint8_t));
+    numPostingAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numPostingAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numPostingKeyAuths = 0;
-    os_memmove(&numPostingKeyAuths, buffer, sizeof(uint8_t));
+    numPostingKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numPostingKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
-    if( argNum == 4) { // posting auth
+    if( argNum == 3) { // posting auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
@@ -486,7 +490,7 @@ void parseHiveAccountUpdate(uint8_t *buffer, uint32_t bufferLength, uint8_t argN
     parsePublicKeyField(buffer, bufferLength, "Memo Key", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    if( argNum == 5) return;
+    if( argNum == 4) return;
 
     os_memset(arg->data, 0, sizeof(arg->data));
 
@@ -498,7 +502,7 @@ void parseHiveWitnessUpdate(uint8_t *buffer, uint32_t bufferLength, uint8_t argN
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Owner", arg, &read, &written);
     if (argNum == 0) return;
@@ -514,34 +518,34 @@ void parseHiveWitnessUpdate(uint8_t *buffer, uint32_t bufferLength, uint8_t argN
     buffer += read; bufferLength -= read;
 
     // props
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
-    snprintf(tmp, sizeof(tmp), "Account Creation Fee: ");
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Account Creation Fee: ");
 
-    parseAssetField(buffer, sizeof(asset_t), "Witness Props", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Witness Props", arg, &read, &written);
     buffer += read; bufferLength -= read;
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s", arg->data);
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s", arg->data);
 
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), " - Max Block Size: ");
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), " - Max Block Size: ");
 
-    parseUint32Field(buffer, sizeof(asset_t), "Witness Props", arg, &read, &written);
+    parseUint32Field(buffer, bufferLength, "Witness Props", arg, &read, &written);
     buffer += read; bufferLength -= read;
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s", arg->data);
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s", arg->data);
 
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), " - HBD Interest Rate: ");
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), " - HBD Interest Rate: ");
 
-    parseUint16Field(buffer, sizeof(asset_t), "Witness Props", arg, &read, &written);
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s", arg->data);
+    parseUint16Field(buffer, bufferLength, "Witness Props", arg, &read, &written);
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s", arg->data);
 
     os_memset(arg->data, 0, sizeof(arg->data));
-    os_memmove(arg->data, tmp, sizeof(tmp));
+    os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
 }
 
 void parseHiveAccountWitnessVote(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Account", arg, &read, &written);
     if (argNum == 0) return;
@@ -551,14 +555,14 @@ void parseHiveAccountWitnessVote(uint8_t *buffer, uint32_t bufferLength, uint8_t
     if (argNum == 1) return;
 
     buffer += read; bufferLength -= read;
-    printString(buffer[0] == 0x01 ? "true" : "false", "Approve", arg);
+    printString(readUint8(buffer, bufferLength) == 0x01 ? "true" : "false", "Approve", arg);
 }
 
 void parseHiveAccountWitnessProxy(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Account", arg, &read, &written);
     if (argNum == 0) return;
@@ -571,7 +575,7 @@ void parseHiveDeleteComment(uint8_t *buffer, uint32_t bufferLength, uint8_t argN
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Author", arg, &read, &written);
     if (argNum == 0) return;
@@ -584,47 +588,45 @@ void parseHiveCustomJson(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum,
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
     uint32_t requiredAuths = 0;
-    read = unpack_variant32(buffer, sizeof(uint32_t), &requiredAuths);
+    read = unpack_variant32(buffer, bufferLength, &requiredAuths);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "[ ");
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "[ ");
 
     for(uint32_t i = 0; i < requiredAuths; ++i) {
         parseStringField(buffer, bufferLength, "Required Auths", arg, &read, &written);
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), i == requiredAuths-1 ? "%s" : "%s, ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), i == requiredAuths-1 ? "%s" : "%s, ", arg->data);
         buffer += read; bufferLength -= read;
     }
 
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), " ]");
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), " ]");
 
     if (argNum == 0) {
-        os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        printString(tmp, "Required Auths", arg); // an empty list sets no label on its own
         return;
     }
 
     uint32_t requiredPostingAuths = 0;
-    read = unpack_variant32(buffer, sizeof(uint32_t), &requiredPostingAuths);
+    read = unpack_variant32(buffer, bufferLength, &requiredPostingAuths);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "[ ");
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "[ ");
 
     for(uint32_t i = 0; i < requiredPostingAuths; ++i) {
-        parseStringField(buffer, bufferLength, "Required Auths", arg, &read, &written);
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), i == requiredPostingAuths-1 ? "%s" : "%s, ", arg->data);
+        parseStringField(buffer, bufferLength, "Required Posting Auths", arg, &read, &written);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), i == requiredPostingAuths-1 ? "%s" : "%s, ", arg->data);
         buffer += read; bufferLength -= read;
     }
 
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), " ]");
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), " ]");
 
     if (argNum == 1) {
-        os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        printString(tmp, "Required Posting Auths", arg);
         return;
     }
 
@@ -639,7 +641,7 @@ void parseHiveCommentOptions(uint8_t *buffer, uint32_t bufferLength, uint8_t arg
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Author", arg, &read, &written);
     if (argNum == 0) return;
@@ -657,17 +659,17 @@ void parseHiveCommentOptions(uint8_t *buffer, uint32_t bufferLength, uint8_t arg
     if (argNum == 3) return;
 
     buffer += read; bufferLength -= read;
-    printString(buffer[0] == 0x01 ? "true" : "false", "Allow Votes", arg);
+    printString(readUint8(buffer, bufferLength) == 0x01 ? "true" : "false", "Allow Votes", arg);
     if (argNum == 4) return;
 
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
-    printString(buffer[0] == 0x01 ? "true" : "false", "Allow Curation Rewards", arg);
+    printString(readUint8(buffer, bufferLength) == 0x01 ? "true" : "false", "Allow Curation Rewards", arg);
     if (argNum == 5) return;
 
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     uint8_t numExtensions = 0;
-    os_memmove(&numExtensions, buffer, sizeof(uint8_t));
+    numExtensions = readUint8(buffer, bufferLength);
 
     if(numExtensions == 0) {
         printString("[]", "Beneficiaries", arg);
@@ -678,39 +680,39 @@ void parseHiveCommentOptions(uint8_t *buffer, uint32_t bufferLength, uint8_t arg
 
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
-    if(buffer[0] != 0x00) THROW(EXCEPTION); // only beneficiaries (0x00) are implemented
+    if(readUint8(buffer, bufferLength) != 0x00) THROW(EXCEPTION); // only beneficiaries (0x00) are implemented
 
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
     uint8_t numBeneficiaries = 0;
-    os_memmove(&numBeneficiaries, buffer, sizeof(uint8_t));
+    numBeneficiaries = readUint8(buffer, bufferLength);
 
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
-    snprintf(tmp, sizeof(tmp), "[ ");
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "[ ");
 
     for(uint8_t i = 0; i < numBeneficiaries; ++i) {
         parseStringField(buffer, bufferLength, "Beneficiaries", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s - ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s - ", arg->data);
         parseUint16Field(buffer, bufferLength, "Beneficiaries", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), i == numBeneficiaries-1 ? "%s" : "%s, ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), i == numBeneficiaries-1 ? "%s" : "%s, ", arg->data);
     }
 
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), " ]");
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), " ]");
 
     os_memset(arg->data, 0, sizeof(arg->data));
-    os_memmove(arg->data, tmp, sizeof(tmp));
+    os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
 }
 
 void parseHiveSetWithdrawVestingRoute(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "From Account", arg, &read, &written);
     if (argNum == 0) return;
@@ -720,31 +722,31 @@ void parseHiveSetWithdrawVestingRoute(uint8_t *buffer, uint32_t bufferLength, ui
     if (argNum == 1) return;
 
     buffer += read; bufferLength -= read;
-    parseUint32Field(buffer, bufferLength, "Percent", arg, &read, &written);
+    parseUint16Field(buffer, bufferLength, "Percent", arg, &read, &written);
     if (argNum == 2) return;
 
     buffer += read; bufferLength -= read;
-    printString(buffer[0] == 0x01 ? "true" : "false", "Autovest", arg);
+    printString(readUint8(buffer, bufferLength) == 0x01 ? "true" : "false", "Autovest", arg);
 }
 
 void parseHiveClaimAccount(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Creator", arg, &read, &written);
     if (argNum == 1) return;
 
     buffer += read; bufferLength -= read;
-    parseAssetField(buffer, sizeof(asset_t), "Fee", arg, &read, &written);
+    parseAssetField(buffer, bufferLength, "Fee", arg, &read, &written);
 }
 
 void parseHiveCreateClaimedAccount(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Creator", arg, &read, &written);
     buffer += read; bufferLength -= read;
@@ -754,124 +756,124 @@ void parseHiveCreateClaimedAccount(uint8_t *buffer, uint32_t bufferLength, uint8
     buffer += read; bufferLength -= read;
     if (argNum == 1) return;
 
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numOwnerAccountAuths = 0;
-    os_memmove(&numOwnerAccountAuths, buffer, sizeof(uint8_t));
+    numOwnerAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numOwnerAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numOwnerKeyAuths = 0;
-    os_memmove(&numOwnerKeyAuths, buffer, sizeof(uint8_t));
+    numOwnerKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numOwnerKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     if( argNum == 2) { // owner auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
-    os_memset(tmp, 0, sizeof(tmp));
+    os_memset(tmp, 0, HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numActiveAccountAuths = 0;
-    os_memmove(&numActiveAccountAuths, buffer, sizeof(uint8_t));
+    numActiveAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numActiveAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numActiveKeyAuths = 0;
-    os_memmove(&numActiveKeyAuths, buffer, sizeof(uint8_t));
+    numActiveKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numActiveKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Active Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     if( argNum == 3) { // active auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
-    os_memset(tmp, 0, sizeof(tmp));
+    os_memset(tmp, 0, HIVE_LIST_BUFFER_SIZE);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     parseUint32Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numPostingAccountAuths = 0;
-    os_memmove(&numPostingAccountAuths, buffer, sizeof(uint8_t));
+    numPostingAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numPostingAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numPostingKeyAuths = 0;
-    os_memmove(&numPostingKeyAuths, buffer, sizeof(uint8_t));
+    numPostingKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numPostingKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Posting Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     if( argNum == 4) { // posting auth
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
@@ -891,7 +893,7 @@ void parseHiveRequestAccountRecovery(uint8_t *buffer, uint32_t bufferLength, uin
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Recovery Account", arg, &read, &written);
     buffer += read; bufferLength -= read;
@@ -903,42 +905,42 @@ void parseHiveRequestAccountRecovery(uint8_t *buffer, uint32_t bufferLength, uin
 
     if (argNum == 1) return;
 
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numOwnerAccountAuths = 0;
-    os_memmove(&numOwnerAccountAuths, buffer, sizeof(uint8_t));
+    numOwnerAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numOwnerAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numOwnerKeyAuths = 0;
-    os_memmove(&numOwnerKeyAuths, buffer, sizeof(uint8_t));
+    numOwnerKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numOwnerKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     os_memset(arg->data, 0, sizeof(arg->data));
-    os_memmove(arg->data, tmp, sizeof(tmp));
+    os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
     return;
 }
 
@@ -946,94 +948,94 @@ void parseHiveRecoverAccount(uint8_t *buffer, uint32_t bufferLength, uint8_t arg
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Account To Recover", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
     if (argNum == 0) return;
 
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numNewOwnerAccountAuths = 0;
-    os_memmove(&numNewOwnerAccountAuths, buffer, sizeof(uint8_t));
+    numNewOwnerAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numNewOwnerAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numNewOwnerKeyAuths = 0;
-    os_memmove(&numNewOwnerKeyAuths, buffer, sizeof(uint8_t));
+    numNewOwnerKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numNewOwnerKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     if (argNum == 1) {
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     };
 
     parseUint32Field(buffer, bufferLength, "Recent Owner Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numRecentOwnerAccountAuths = 0;
-    os_memmove(&numRecentOwnerAccountAuths, buffer, sizeof(uint8_t));
+    numRecentOwnerAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numRecentOwnerAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "Recent Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Recent Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numRecentOwnerKeyAuths = 0;
-    os_memmove(&numRecentOwnerKeyAuths, buffer, sizeof(uint8_t));
+    numRecentOwnerKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numRecentOwnerKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "Recent Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "Recent Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     os_memset(arg->data, 0, sizeof(arg->data));
-    os_memmove(arg->data, tmp, sizeof(tmp));
+    os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
 }
 
 void parseHiveChangeRecoveryAccount(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Account To Recover", arg, &read, &written);
     if (argNum == 0) return;
@@ -1045,7 +1047,7 @@ void parseHiveTransferToSavings(uint8_t *buffer, uint32_t bufferLength, uint8_t
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "From", arg, &read, &written);
     if (argNum == 0) return;
@@ -1066,7 +1068,7 @@ void parseHiveTransferFromSavings(uint8_t *buffer, uint32_t bufferLength, uint8_
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "From", arg, &read, &written);
     if (argNum == 0) return;
@@ -1091,7 +1093,7 @@ void parseHiveCancelTransferFromSavings(uint8_t *buffer, uint32_t bufferLength,
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "From", arg, &read, &written);
     if (argNum == 0) return;
@@ -1104,20 +1106,20 @@ void parseHiveDeclineVotingRights(uint8_t *buffer, uint32_t bufferLength, uint8_
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Account", arg, &read, &written);
     if (argNum == 0) return;
 
     buffer += read; bufferLength -= read;
-    printString(buffer[0] == 0x01 ? "true" : "false", "Decline", arg);
+    printString(readUint8(buffer, bufferLength) == 0x01 ? "true" : "false", "Decline", arg);
 }
 
 void parseHiveResetAccount(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Reset Account", arg, &read, &written);
     if (argNum == 0) return;
@@ -1128,49 +1130,49 @@ void parseHiveResetAccount(uint8_t *buffer, uint32_t bufferLength, uint8_t argNu
 
     buffer += read; bufferLength -= read;
 
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
     parseUint32Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "Weight: %s - ", arg->data);
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "Weight: %s - ", arg->data);
     os_memset(arg->data, 0, sizeof(arg->data));
 
     uint8_t numNewOwnerAccountAuths = 0;
-    os_memmove(&numNewOwnerAccountAuths, buffer, sizeof(uint8_t));
+    numNewOwnerAccountAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numNewOwnerAccountAuths; ++i) {
         parseStringField(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "A%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "A%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     uint8_t numNewOwnerKeyAuths = 0;
-    os_memmove(&numNewOwnerKeyAuths, buffer, sizeof(uint8_t));
+    numNewOwnerKeyAuths = readUint8(buffer, bufferLength);
     buffer += sizeof(uint8_t); bufferLength -= sizeof(uint8_t);
 
     for (uint8_t i = 0; i < numNewOwnerKeyAuths; ++i) {
         parsePublicKeyField(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "K%d - %s:", i+1, arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "K%d - %s:", i+1, arg->data);
         parseUint16Field(buffer, bufferLength, "New Owner Auth", arg, &read, &written);
         buffer += read; bufferLength -= read;
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), "%s || ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), "%s || ", arg->data);
     }
 
     os_memset(arg->data, 0, sizeof(arg->data));
-    os_memmove(arg->data, tmp, sizeof(tmp));
+    os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
 }
 
 void parseHiveSetResetAccount(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Account", arg, &read, &written);
     if (argNum == 0) return;
@@ -1187,7 +1189,7 @@ void parseHiveClaimRewardBalance(uint8_t *buffer, uint32_t bufferLength, uint8_t
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Account", arg, &read, &written);
     if (argNum == 0) return;
@@ -1208,7 +1210,7 @@ void parseHiveDelegateVestingShares(uint8_t *buffer, uint32_t bufferLength, uint
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Delegator", arg, &read, &written);
     if (argNum == 0) return;
@@ -1225,7 +1227,7 @@ void parseHiveCreateProposal(uint8_t *buffer, uint32_t bufferLength, uint8_t arg
     uint32_t read = 0;
     uint32_t written = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Creator", arg, &read, &written);
     if (argNum == 0) return;
@@ -1260,35 +1262,35 @@ void parseHiveUpdateProposalVotes(uint8_t *buffer, uint32_t bufferLength, uint8_
 
     uint32_t numProposals = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Voter", arg, &read, &written);
     if (argNum == 0) return;
 
     buffer += read; bufferLength -= read;
 
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
-    read = unpack_variant32(buffer, sizeof(uint32_t), &numProposals);
+    read = unpack_variant32(buffer, bufferLength, &numProposals);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "[ ");
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "[ ");
 
     for(uint32_t i = 0; i < numProposals; ++i) {
         parseInt64Field(buffer, bufferLength, "Proposal IDs", arg, &read, &written);
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), i == numProposals-1 ? "%s" : "%s, ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), i == numProposals-1 ? "%s" : "%s, ", arg->data);
         buffer += read; bufferLength -= read;
     }
 
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), " ]");
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), " ]");
 
     if (argNum == 1) {
         os_memset(arg->data, 0, sizeof(arg->data));
-        os_memmove(arg->data, tmp, sizeof(tmp));
+        os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
         return;
     }
 
-    printString(buffer[0] == 0x01 ? "true" : "false", "Approve", arg);
+    printString(readUint8(buffer, bufferLength) == 0x01 ? "true" : "false", "Approve", arg);
 }
 
 void parseHiveRemoveProposal(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
@@ -1297,28 +1299,28 @@ void parseHiveRemoveProposal(uint8_t *buffer, uint32_t bufferLength, uint8_t arg
 
     uint32_t numProposals = 0;
 
-    buffer++; // opType byte
+    buffer++; bufferLength--; // opType byte
 
     parseStringField(buffer, bufferLength, "Proposal Owner", arg, &read, &written);
     if (argNum == 0) return;
 
     buffer += read; bufferLength -= read;
 
-    char tmp[128];
+    char *tmp = scratchAlloc(HIVE_LIST_BUFFER_SIZE);
 
-    read = unpack_variant32(buffer, sizeof(uint32_t), &numProposals);
+    read = unpack_variant32(buffer, bufferLength, &numProposals);
     buffer += read; bufferLength -= read;
 
-    snprintf(tmp, sizeof(tmp), "[ ");
+    snprintf(tmp, HIVE_LIST_BUFFER_SIZE, "[ ");
 
     for(uint32_t i = 0; i < numProposals; ++i) {
         parseInt64Field(buffer, bufferLength, "Proposal IDs", arg, &read, &written);
-        snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), i == numProposals-1 ? "%s" : "%s, ", arg->data);
+        snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), i == numProposals-1 ? "%s" : "%s, ", arg->data);
         buffer += read; bufferLength -= read;
     }
 
-    snprintf(tmp + strlen(tmp), sizeof(tmp) - strlen(tmp), " ]");
+    snprintf(tmp + strlen(tmp), HIVE_LIST_BUFFER_SIZE - strlen(tmp), " ]");
 
     os_memset(arg->data, 0, sizeof(arg->data));
-    os_memmove(arg->data, tmp, sizeof(tmp));
+    os_memmove(arg->data, tmp, HIVE_LIST_BUFFER_SIZE);
 }
@@ -0,0 +1,86 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "hive_profile.h"
+
+#ifdef DEBUG_APP
+
+#include "os.h"
+
+profileCounters_t profileCounters;
+volatile uint32_t profileTickCount;
+
+void profileReset(void) {
+    os_memset(&profileCounters, 0, sizeof(profileCounters));
+    profileCounters.sessionStart = profileTickCount;
+}
+
+void profileTick(void) {
+    profileTickCount++;
+}
+
+void profileCount(profilePhase_e phase, uint32_t bytes) {
+    profilePhase_t *counters = &profileCounters.phase[phase];
+    counters->calls++;
+    counters->bytes += bytes;
+}
+
+void profileApdu(void) {
+    profileCounters.apduCount++;
+}
+
+void profileRetry(void) {
+    profileCounters.canonicalRetries++;
+}
+
+void profileSessionEnd(void) {
+    profileCounters.sessionTicks = profileTickCount - profileCounters.sessionStart;
+}
+
+static uint32_t writeU32(uint8_t *buffer, uint32_t value) {
+    buffer[0] = value >> 24;
+    buffer[1] = value >> 16;
+    buffer[2] = value >> 8;
+    buffer[3] = value;
+    return sizeof(uint32_t);
+}
+
+/**
+ * Response layout, all values big endian uint32:
+ * [PHASE_COUNT][calls bytes]*PHASE_COUNT[retries][apdus][session ticks]
+*/
+uint32_t profileSerialize(uint8_t *buffer, uint32_t length) {
+    uint32_t tx = 0;
+    uint32_t i;
+
+    if (length < 1 + PROFILE_PHASE_COUNT * 2 * sizeof(uint32_t) + 3 * sizeof(uint32_t)) {
+        THROW(EXCEPTION_OVERFLOW);
+    }
+
+    buffer[tx++] = PROFILE_PHASE_COUNT;
+    for (i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        tx += writeU32(buffer + tx, profileCounters.phase[i].calls);
+        tx += writeU32(buffer + tx, profileCounters.phase[i].bytes);
+    }
+    tx += writeU32(buffer + tx, profileCounters.canonicalRetries);
+    tx += writeU32(buffer + tx, profileCounters.apduCount);
+    tx += writeU32(buffer + tx, profileCounters.sessionTicks);
+
+    return tx;
+}
+
+#endif // DEBUG_APP
@@ -0,0 +1,85 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HIVE_PROFILE_H__
+#define __HIVE_PROFILE_H__
+
+#include <stdint.h>
+
+/**
+ * Signing session profiler, only built with DEBUG_APP.
+ * Every phase keeps the number of calls and the number of bytes it handled.
+ * Counters are cleared by the first APDU of a signing session and read back
+ * with INS_GET_PROFILE.
+ *
+ * Applications cannot read the core cycle counter and the ticker event
+ * count only advances while the app waits for I/O, so phases are not timed
+ * on the device: the ticks cover the whole session (USB round trips and
+ * review screens). Phase timings come from the host build (bench_parser)
+ * or from Speculos (benchSpeculos.py).
+*/
+
+typedef enum profilePhase_e {
+    PROFILE_TLV_DECODE = 0,     // parseTx, including the nested phases below
+    PROFILE_HASH,               // cx_hash over the transaction
+    PROFILE_OP_BUFFER,          // copy of operation data into the staging buffer
+    PROFILE_PRINT_ARGUMENT,     // rendering of a single argument for review
+    PROFILE_KEY_DERIVATION,     // os_perso_derive_node_bip32
+    PROFILE_NONCE,              // rng_rfc6979
+    PROFILE_ECDSA_SIGN,         // cx_ecdsa_sign
+    PROFILE_CHECK_ARGUMENT,     // rendering of a staged argument, to refuse it before review
+    PROFILE_PHASE_COUNT
+} profilePhase_e;
+
+#ifdef DEBUG_APP
+
+typedef struct profilePhase_t {
+    uint32_t calls;
+    uint32_t bytes;
+} profilePhase_t;
+
+typedef struct profileCounters_t {
+    profilePhase_t phase[PROFILE_PHASE_COUNT];
+    uint32_t canonicalRetries;
+    uint32_t apduCount;
+    uint32_t sessionStart;
+    uint32_t sessionTicks;
+} profileCounters_t;
+
+extern profileCounters_t profileCounters;
+extern volatile uint32_t profileTickCount;
+
+void profileReset(void);
+void profileTick(void);
+void profileCount(profilePhase_e phase, uint32_t bytes);
+void profileApdu(void);
+void profileRetry(void);
+void profileSessionEnd(void);
+uint32_t profileSerialize(uint8_t *buffer, uint32_t length);
+
+#else
+
+#define profileReset()
+#define profileTick()
+#define profileCount(phase, bytes)
+#define profileApdu()
+#define profileRetry()
+#define profileSessionEnd()
+
+#endif // DEBUG_APP
+
+#endif // __HIVE_PROFILE_H__
@@ -0,0 +1,55 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "hive_scratch.h"
+#include "os.h"
+
+static uint32_t scratchArena[HIVE_SCRATCH_SIZE / sizeof(uint32_t)];
+static uint32_t scratchTop;
+
+void scratchReset(void) {
+    scratchTop = 0;
+}
+
+/**
+ * Bump allocator. Returned memory is zeroed and word aligned.
+*/
+void *scratchAlloc(uint32_t size) {
+    uint32_t words = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    if (words > sizeof(scratchArena) / sizeof(uint32_t) - scratchTop) {
+        PRINTF("scratchAlloc overflow\n");
+        THROW(EXCEPTION_OVERFLOW);
+    }
+
+    uint32_t *ptr = scratchArena + scratchTop;
+    scratchTop += words;
+    os_memset(ptr, 0, words * sizeof(uint32_t));
+
+    return ptr;
+}
+
+/**
+ * Release the given allocation and everything allocated after it.
+*/
+void scratchRelease(void *ptr) {
+    uint32_t *word = (uint32_t *) ptr;
+    if (word < scratchArena || word > scratchArena + scratchTop) {
+        PRINTF("scratchRelease invalid pointer\n");
+        THROW(INVALID_PARAMETER);
+    }
+    scratchTop = word - scratchArena;
+}
@@ -0,0 +1,40 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HIVE_SCRATCH_H__
+#define __HIVE_SCRATCH_H__
+
+#include <stdint.h>
+#include "hive_config.h"
+
+/**
+ * Statically allocated scratch arena for rendering temporaries.
+ * Operation renderers take their list builder from here and the
+ * string helpers (append, b58enc) take their working buffers on top of it,
+ * so none of them put variable sized data on the stack.
+ * The arena is reset at the start of every printArgument call, nested
+ * helpers release what they took in LIFO order.
+ *
+ * Worst case usage is one list builder plus one helper buffer:
+ * HIVE_SCRATCH_SIZE = HIVE_LIST_BUFFER_SIZE + HIVE_SCRATCH_TEMP_SIZE.
+*/
+
+void scratchReset(void);
+void *scratchAlloc(uint32_t size);
+void scratchRelease(void *ptr);
+
+#endif // __HIVE_SCRATCH_H__
@@ -0,0 +1,165 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "hive_stack.h"
+
+#ifdef HIVE_STACK_PROFILE
+
+#include "os.h"
+
+#define STACK_PAINT 0xA5A5A5A5
+// Words left untouched below the caller frame while painting
+#define STACK_PAINT_MARGIN 16
+
+// Provided by the SDK linker script
+extern uint32_t _stack;
+extern uint32_t _estack;
+extern uint32_t _bss;
+extern uint32_t _ebss;
+
+typedef struct stackInsPeak_t {
+    uint8_t ins;
+    uint16_t peak;
+} stackInsPeak_t;
+
+static stackInsPeak_t insPeaks[STACK_PROFILE_MAX_INS];
+static uint16_t opPeaks[STACK_PROFILE_MAX_OP_TYPE];
+
+/**
+ * Paint everything between the stack limit and the current frame.
+*/
+static void stackPaint(void) {
+    uint32_t *word = &_stack;
+    uint32_t *top = (uint32_t *) __builtin_frame_address(0) - STACK_PAINT_MARGIN;
+    while (word < top) {
+        *word++ = STACK_PAINT;
+    }
+}
+
+/**
+ * Bytes between the top of the stack and the deepest overwritten word.
+*/
+static uint32_t stackPeak(void) {
+    uint32_t *word = &_stack;
+    while (word < &_estack && *word == STACK_PAINT) {
+        word++;
+    }
+    return (uint32_t) ((uint8_t *) &_estack - (uint8_t *) word);
+}
+
+void stackProfileInit(void) {
+    os_memset(insPeaks, 0, sizeof(insPeaks));
+    os_memset(opPeaks, 0, sizeof(opPeaks));
+    stackPaint();
+}
+
+/**
+ * Start a measured section. The returned value is the peak reached before
+ * it, so nested sections do not hide each other.
+*/
+uint32_t stackProfileMark(void) {
+    uint32_t peak = stackPeak();
+    stackPaint();
+    return peak;
+}
+
+/**
+ * End a measured section and return its peak. The deepest of the peak
+ * before the section and of the section itself is marked again, so the
+ * enclosing section still sees it.
+*/
+static uint32_t stackProfileEnd(uint32_t mark) {
+    uint32_t peak = stackPeak();
+    uint32_t *word = (uint32_t *) ((uint8_t *) &_estack - (mark > peak ? mark : peak));
+
+    stackPaint();
+    // words above this frame are live and were not painted
+    if (word >= &_stack && word < (uint32_t *) __builtin_frame_address(0)) {
+        *word = ~STACK_PAINT;
+    }
+    return peak;
+}
+
+void stackProfileRecordIns(uint8_t ins, uint32_t mark) {
+    uint32_t peak = stackProfileEnd(mark);
+    uint32_t i;
+
+    for (i = 0; i < STACK_PROFILE_MAX_INS; i++) {
+        if (insPeaks[i].peak == 0 || insPeaks[i].ins == ins) {
+            insPeaks[i].ins = ins;
+            if (peak > insPeaks[i].peak) {
+                insPeaks[i].peak = peak;
+            }
+            return;
+        }
+    }
+}
+
+void stackProfileRecordOp(uint8_t opType, uint32_t mark) {
+    uint32_t peak = stackProfileEnd(mark);
+
+    if (opType < STACK_PROFILE_MAX_OP_TYPE && peak > opPeaks[opType]) {
+        opPeaks[opType] = peak;
+    }
+}
+
+/**
+ * Response layout, all values big endian uint16:
+ * [stack size][static RAM][INS count]([ins u8][peak])*[op count]([opType u8][peak])*
+*/
+uint32_t stackProfileSerialize(uint8_t *buffer, uint32_t length) {
+    uint32_t stackSize = (uint8_t *) &_estack - (uint8_t *) &_stack;
+    uint32_t staticRam = (uint8_t *) &_ebss - (uint8_t *) &_bss;
+    uint32_t tx = 0;
+    uint32_t count = 0;
+    uint32_t i;
+
+    if (length < 6 + STACK_PROFILE_MAX_INS * 3 + STACK_PROFILE_MAX_OP_TYPE * 3) {
+        THROW(EXCEPTION_OVERFLOW);
+    }
+
+    buffer[tx++] = stackSize >> 8;
+    buffer[tx++] = stackSize;
+    buffer[tx++] = staticRam >> 8;
+    buffer[tx++] = staticRam;
+
+    for (i = 0; i < STACK_PROFILE_MAX_INS && insPeaks[i].peak != 0; i++);
+    buffer[tx++] = i;
+    for (i = 0; i < STACK_PROFILE_MAX_INS && insPeaks[i].peak != 0; i++) {
+        buffer[tx++] = insPeaks[i].ins;
+        buffer[tx++] = insPeaks[i].peak >> 8;
+        buffer[tx++] = insPeaks[i].peak;
+    }
+
+    for (i = 0; i < STACK_PROFILE_MAX_OP_TYPE; i++) {
+        if (opPeaks[i] != 0) {
+            count++;
+        }
+    }
+    buffer[tx++] = count;
+    for (i = 0; i < STACK_PROFILE_MAX_OP_TYPE; i++) {
+        if (opPeaks[i] != 0) {
+            buffer[tx++] = i;
+            buffer[tx++] = opPeaks[i] >> 8;
+            buffer[tx++] = opPeaks[i];
+        }
+    }
+
+    return tx;
+}
+
+#endif // HIVE_STACK_PROFILE
@@ -0,0 +1,51 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HIVE_STACK_H__
+#define __HIVE_STACK_H__
+
+#include <stdint.h>
+
+/**
+ * Stack high-water instrumentation, built with `make STACK_PROFILE=1`.
+ * The unused part of the stack is painted with a known pattern, after a
+ * measured section the deepest overwritten word gives the peak usage.
+ * Peaks are kept per INS handler and per printArgument operation type and
+ * read back, together with the static RAM figures, with INS_GET_STACK_PROFILE.
+*/
+
+#ifdef HIVE_STACK_PROFILE
+
+#define STACK_PROFILE_MAX_INS 8
+#define STACK_PROFILE_MAX_OP_TYPE 64
+
+void stackProfileInit(void);
+uint32_t stackProfileMark(void);
+void stackProfileRecordIns(uint8_t ins, uint32_t mark);
+void stackProfileRecordOp(uint8_t opType, uint32_t mark);
+uint32_t stackProfileSerialize(uint8_t *buffer, uint32_t length);
+
+#else
+
+#define stackProfileInit()
+#define stackProfileMark() (0)
+#define stackProfileRecordIns(ins, mark) ((void) (ins), (void) (mark))
+#define stackProfileRecordOp(opType, mark) ((void) (mark))
+
+#endif // HIVE_STACK_PROFILE
+
+#endif // __HIVE_STACK_H__
@@ -21,23 +21,94 @@
 #include "cx.h"
 #include "hive_types.h"
 #include "hive_utils.h"
+#include "hive_scratch.h"
+#include "hive_profile.h"
+#include "hive_stack.h"
 #include "hive_parse.h"
 #include "hive_parse_operations.h"
 #include "hive_parse_unknown.h"
 
+// The budget is for the devices' 32-bit layout, a 64-bit host build has wider pointers
+#if UINTPTR_MAX == UINT32_MAX
+_Static_assert(sizeof(txProcessingContext_t) + sizeof(txProcessingContent_t) <= HIVE_PARSER_RAM_BUDGET,
+               "parser state exceeds the RAM budget of the target memory profile");
+#endif
+_Static_assert(TX_HASH_BLOCK_SIZE <= UINT8_MAX, "hashBufferPos is a uint8_t");
+
+// keep in sync with the switches of processActionData() and printArgument()
+const uint8_t supportedOpTypes[HIVE_OP_TYPE_BITMAP_SIZE] = {
+    0xFF, // 0-7 vote .. limit_order_cancel, feed_publish
+    0x3F, // 8-13 convert .. account_witness_proxy
+    0xDE, // 17-20 delete_comment .. set_withdraw_vesting_route, 22-23 claim_account, create_claimed_account
+    0x07, // 24-26 request_account_recovery .. change_recovery_account
+    0xF7, // 32-34 savings, 36-39 decline_voting_rights .. claim_reward_balance
+    0x71, // 40 delegate_vesting_shares, 44-46 proposals
+};
+
+const hiveNetwork_t hiveNetworks[HIVE_NETWORK_COUNT] = {
+    {0x01, "Hive", {0xbe, 0xea, 0xb0, 0xde, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {0x02, "Testnet", {0x18, 0xdc, 0xf0, 0xa2, 0x85, 0x36, 0x5f, 0xc5, 0x8b, 0x71, 0xf1, 0x8b, 0x3d, 0x3f, 0xec, 0x95,
+                       0x4a, 0xa0, 0xc1, 0x41, 0xc4, 0x4e, 0x4e, 0x5c, 0xb4, 0xcf, 0x77, 0x7b, 0x9e, 0xab, 0x27, 0x4e}},
+};
+
 void initTxContext(txProcessingContext_t *context, 
                    cx_sha256_t *sha256, 
-                   cx_sha256_t *dataSha256, 
                    txProcessingContent_t *processingContent,
                    uint8_t dataAllowed) {
     os_memset(context, 0, sizeof(txProcessingContext_t));
     context->sha256 = sha256;
-    context->dataSha256 = dataSha256;
     context->content = processingContent;
+#if HIVE_OP_STAGING_SLOTS > 1
+    context->staged = &context->stagedContent;
+    context->reviewBuffer = context->reviewDataBuffer;
+#else
+    context->staged = processingContent;
+    context->reviewBuffer = context->actionDataBuffer;
+#endif
     context->state = TLV_CHAIN_ID;
+    context->networkCandidates = (1 << HIVE_NETWORK_COUNT) - 1;
     context->dataAllowed = dataAllowed;
+    context->fault.argument = FAULT_NO_ARGUMENT;
     cx_sha256_init(context->sha256);
-    cx_sha256_init(context->dataSha256);
+}
+
+static uint32_t currentOffset(txProcessingContext_t *context) {
+    return context->bufferOffset + (context->workBuffer - context->buffer);
+}
+
+/**
+ * Remember where the transaction was refused, the first fault wins.
+*/
+static void recordFault(txProcessingContext_t *context, txFault_e code) {
+    if (context->fault.code != FAULT_NONE) {
+        return;
+    }
+    context->fault.code = code;
+    context->fault.offset = context->fieldOffset;
+    context->fault.state = context->state;
+    context->fault.opIndex = context->currentOpIndex;
+}
+
+static void raiseFault(txProcessingContext_t *context, txFault_e code) {
+    recordFault(context, code);
+    THROW(EXCEPTION);
+}
+
+uint32_t faultSerialize(txProcessingContext_t *context, uint8_t *out, uint32_t outLength) {
+    txFault_t *fault = &context->fault;
+    if (outLength < 8) {
+        return 0;
+    }
+    out[0] = fault->offset >> 24;
+    out[1] = fault->offset >> 16;
+    out[2] = fault->offset >> 8;
+    out[3] = fault->offset;
+    out[4] = fault->state;
+    out[5] = fault->opIndex >> 8;
+    out[6] = fault->opIndex;
+    out[7] = fault->argument;
+    return 8;
 }
 
 uint8_t readTxByte(txProcessingContext_t *context) {
@@ -53,180 +124,188 @@ uint8_t readTxByte(txProcessingContext_t *context) {
 }
 
 static void processHiveVote(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-    strcpy(context->content->opName, "vote");
+    context->staged->argumentCount = 4;
+    strcpy(context->staged->opName, "vote");
 }
 
 static void processHiveComment(txProcessingContext_t *context) {
-    context->content->argumentCount = 7;
-    strcpy(context->content->opName, "comment");
+    context->staged->argumentCount = 7;
+    strcpy(context->staged->opName, "comment");
 }
 
 static void processHiveTransfer(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-    strcpy(context->content->opName, "transfer");
+    context->staged->argumentCount = 4;
+    strcpy(context->staged->opName, "transfer");
 }
 
 static void processHiveTransferToVesting(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "transfer_to_vesting");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "transfer_to_vesting");
 }
 
 static void processHiveWithdrawVesting(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "withdraw_vesting");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "withdraw_vesting");
 }
 
 static void processHiveLimitOrderCreate(txProcessingContext_t *context) {
-    context->content->argumentCount = 6;
-    strcpy(context->content->opName, "limit_order_create");
+    context->staged->argumentCount = 6;
+    strcpy(context->staged->opName, "limit_order_create");
 }
 
 static void processHiveLimitOrderCancel(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "limit_order_cancel");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "limit_order_cancel");
 }
 
 static void processHiveFeedPublish(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "feed_publish");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "feed_publish");
 }
 
 static void processHiveConvert(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "convert");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "convert");
 }
 
 static void processHiveAccountCreate(txProcessingContext_t *context) {
-    context->content->argumentCount = 8;
-    strcpy(context->content->opName, "account_create");
+    context->staged->argumentCount = 8;
+    strcpy(context->staged->opName, "account_create");
 }
 
 static void processHiveAccountUpdate(txProcessingContext_t *context) {
-    context->content->argumentCount = 7;
-    strcpy(context->content->opName, "account_update");
+    context->staged->argumentCount = 6;
+    strcpy(context->staged->opName, "account_update");
 }
 
 static void processHiveWitnessUpdate(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-    strcpy(context->content->opName, "witness_update");
+    context->staged->argumentCount = 4;
+    strcpy(context->staged->opName, "witness_update");
 }
 
 static void processHiveAccountWitnessVote(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "account_witness_vote");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "account_witness_vote");
 }
 
 static void processHiveAccountWitnessProxy(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "account_witness_proxy");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "account_witness_proxy");
 }
 
 static void processHiveDeleteComment(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "delete_comment");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "delete_comment");
 }
 
 static void processHiveCustomJson(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-    strcpy(context->content->opName, "custom_json");
+    context->staged->argumentCount = 4;
+    strcpy(context->staged->opName, "custom_json");
 }
 
 static void processHiveCommentOptions(txProcessingContext_t *context) {
-    context->content->argumentCount = 7;
-    strcpy(context->content->opName, "comment_options");
+    context->staged->argumentCount = 7;
+    strcpy(context->staged->opName, "comment_options");
 }
 
 static void processHiveSetWithdrawVestingRoute(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "set_withdraw_vesting_route");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "set_withdraw_vesting_route");
 }
 
 static void processHiveClaimAccount(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "claim_account");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "claim_account");
 }
 
 static void processHiveCreateClaimedAccount(txProcessingContext_t *context) {
-    context->content->argumentCount = 7;
-    strcpy(context->content->opName, "create_claimed_account");
+    context->staged->argumentCount = 7;
+    strcpy(context->staged->opName, "create_claimed_account");
 }
 
 static void processHiveRequestAccountRecovery(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "request_account_recovery");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "request_account_recovery");
 }
 
 static void processHiveRecoverAccount(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "recover_account");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "recover_account");
 }
 
 static void processHiveChangeRecoveryAccount(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "change_recovery_account");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "change_recovery_account");
 }
 
 static void processHiveTransferToSavings(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-    strcpy(context->content->opName, "transfer_to_savings");
+    context->staged->argumentCount = 4;
+    strcpy(context->staged->opName, "transfer_to_savings");
 }
 
 static void processHiveTransferFromSavings(txProcessingContext_t *context) {
-    context->content->argumentCount = 5;
-    strcpy(context->content->opName, "transfer_from_savings");
+    context->staged->argumentCount = 5;
+    strcpy(context->staged->opName, "transfer_from_savings");
 }
 
 static void processHiveCancelTransferFromSavings(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "cancel_transfer_from_savings");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "cancel_transfer_from_savings");
 }
 
 static void processHiveDeclineVotingRights(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "decline_voting_rights");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "decline_voting_rights");
 }
 
 static void processHiveResetAccount(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "reset_account");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "reset_account");
 }
 
 static void processHiveSetResetAccount(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "set_reset_account");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "set_reset_account");
 }
 
 static void processHiveClaimRewardBalance(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-    strcpy(context->content->opName, "claim_reward_balance");
+    context->staged->argumentCount = 4;
+    strcpy(context->staged->opName, "claim_reward_balance");
 }
 
 static void processHiveDelegateVestingShares(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "delegate_vesting_shares");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "delegate_vesting_shares");
 }
 
 static void processHiveCreateProposal(txProcessingContext_t *context) {
-    context->content->argumentCount = 7;
-    strcpy(context->content->opName, "create_proposal");
+    context->staged->argumentCount = 7;
+    strcpy(context->staged->opName, "create_proposal");
 }
 
 static void processHiveUpdateProposalVotes(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-    strcpy(context->content->opName, "update_proposal_votes");
+    context->staged->argumentCount = 3;
+    strcpy(context->staged->opName, "update_proposal_votes");
 }
 
 static void processHiveRemoveProposal(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-    strcpy(context->content->opName, "remove_proposal");
+    context->staged->argumentCount = 2;
+    strcpy(context->staged->opName, "remove_proposal");
 }
 
-void printArgument(uint8_t argNum, txProcessingContext_t *context) {
-    uint8_t opType = context->content->opType;
-    uint8_t *buffer = context->actionDataBuffer;
-    uint32_t bufferLength = context->currentActionDataBufferLength;
-    actionArgument_t *arg =  &context->content->arg;
+static void renderArgument(uint8_t argNum, txProcessingContent_t *content,
+                           uint8_t *buffer, uint32_t bufferLength, profilePhase_e phase) {
+    uint8_t opType = content->opType;
+    actionArgument_t *arg =  &content->arg;
+
+    uint32_t stackMark = stackProfileMark();
+
+    // the buffer starts with the opType byte
+    if (bufferLength == 0) {
+        THROW(EXCEPTION);
+    }
+
+    scratchReset();
 
     switch (opType) {
     case 0:
@@ -335,20 +414,98 @@ void printArgument(uint8_t argNum, txProcessingContext_t *context) {
         THROW(EXCEPTION);
     }
 
+    profileCount(phase, strlen(arg->data));
+    stackProfileRecordOp(opType, stackMark);
+
     return;
 }
 
+void printArgument(uint8_t argNum, txProcessingContext_t *context) {
+    renderArgument(argNum, context->content, context->reviewBuffer, context->reviewBufferLength,
+                   PROFILE_PRINT_ARGUMENT);
+}
+
+void presentAction(txProcessingContext_t *context) {
+#if HIVE_OP_STAGING_SLOTS > 1
+    context->content->opType = context->staged->opType;
+    context->content->argumentCount = context->staged->argumentCount;
+    os_memmove(context->content->opName, context->staged->opName, sizeof(context->content->opName));
+    os_memmove(context->reviewDataBuffer, context->actionDataBuffer, context->currentActionDataBufferLength);
+#endif
+    context->reviewBufferLength = context->currentActionDataBufferLength;
+    context->actionPending = false;
+}
+
+/**
+ * The transaction id hash gets the same bytes, less the chain id.
+*/
+static void hashTxIdData(txProcessingContext_t *context, uint8_t *buffer, uint32_t length) {
+    uint32_t skip = 0;
+
+    if (context->hashedLength < HIVE_CHAIN_ID_SIZE) {
+        skip = HIVE_CHAIN_ID_SIZE - context->hashedLength;
+        if (skip > length) {
+            skip = length;
+        }
+    }
+    context->hashedLength += length;
+    if (context->txIdSha256 != NULL && length > skip) {
+        cx_hash(&context->txIdSha256->header, 0, buffer + skip, length - skip, NULL, 0);
+    }
+}
+
+static void hashBlocks(txProcessingContext_t *context, uint8_t *buffer, uint32_t length) {
+    cx_hash(&context->sha256->header, 0, buffer, length, NULL, 0);
+    hashTxIdData(context, buffer, length);
+    profileCount(PROFILE_HASH, length);
+}
+
 /**
  * Sequentially hash an incoming data.
  * Hash functionality is moved out here in order to reduce 
  * dependencies on specific hash implementation.
+ * Every cx_hash call is a syscall, so fields and chunk fragments are staged
+ * and only whole blocks are hashed.
 */
 static void hashTxData(txProcessingContext_t *context, uint8_t *buffer, uint32_t length) {
-    cx_hash(&context->sha256->header, 0, buffer, length, NULL, 0);
+    uint32_t blocks;
+
+    if (context->hashBufferPos + length < sizeof(context->hashBuffer)) {
+        os_memmove(context->hashBuffer + context->hashBufferPos, buffer, length);
+        context->hashBufferPos += length;
+        return;
+    }
+    if (context->hashBufferPos > 0) {
+        uint32_t fill = sizeof(context->hashBuffer) - context->hashBufferPos;
+        os_memmove(context->hashBuffer + context->hashBufferPos, buffer, fill);
+        hashBlocks(context, context->hashBuffer, sizeof(context->hashBuffer));
+        buffer += fill;
+        length -= fill;
+    }
+    // whole blocks are hashed in place
+    blocks = length - length % sizeof(context->hashBuffer);
+    if (blocks > 0) {
+        hashBlocks(context, buffer, blocks);
+    }
+    os_memmove(context->hashBuffer, buffer + blocks, length - blocks);
+    context->hashBufferPos = length - blocks;
+}
+
+void hashTxFinalize(txProcessingContext_t *context, uint8_t *out, uint32_t outLength) {
+    cx_hash(&context->sha256->header, CX_LAST, context->hashBuffer, context->hashBufferPos, out, outLength);
+    hashTxIdData(context, context->hashBuffer, context->hashBufferPos);
+    profileCount(PROFILE_HASH, context->hashBufferPos);
+    context->hashBufferPos = 0;
 }
 
-static void hashActionData(txProcessingContext_t *context, uint8_t *buffer, uint32_t length) {
-    cx_hash(&context->dataSha256->header, 0, buffer, length, NULL, 0);
+void hashTxIdStart(txProcessingContext_t *context, cx_sha256_t *sha256) {
+    context->txIdSha256 = sha256;
+    cx_sha256_init(context->txIdSha256);
+}
+
+void hashTxIdFinalize(txProcessingContext_t *context, uint8_t *out, uint32_t outLength) {
+    cx_hash(&context->txIdSha256->header, CX_LAST, NULL, 0, out, outLength);
+    profileCount(PROFILE_HASH, 0);
 }
 
 /**
@@ -379,6 +536,62 @@ static void processField(txProcessingContext_t *context) {
     }
 }
 
+/**
+ * Chain id field, either the chain id or a network selector standing for it.
+ * The transaction is hashed with the chain id in both cases.
+*/
+static void processChainIdField(txProcessingContext_t *context) {
+    uint8_t *data = context->workBuffer;
+    uint32_t pos = context->currentFieldPos;
+    uint32_t i;
+
+    if (context->currentFieldLength == 1) {
+        uint8_t selector;
+        if (context->commandLength == 0) {
+            return;
+        }
+        selector = readTxByte(context);
+        for (i = 0; i < HIVE_NETWORK_COUNT && hiveNetworks[i].selector != selector; i++);
+        if (i == HIVE_NETWORK_COUNT) {
+            PRINTF("Unknown network selector\n");
+            raiseFault(context, FAULT_NETWORK);
+        }
+        hashTxData(context, (uint8_t *) hiveNetworks[i].chainId, HIVE_CHAIN_ID_SIZE);
+        context->network = i + 1;
+        context->state++;
+        context->processingField = false;
+        return;
+    }
+
+    if (context->currentFieldLength != HIVE_CHAIN_ID_SIZE) {
+        context->networkCandidates = 0;
+    }
+    processField(context);
+    // match what processField() consumed against the known chain ids
+    for (; pos < context->currentFieldPos && context->networkCandidates != 0; pos++, data++) {
+        for (i = 0; i < HIVE_NETWORK_COUNT; i++) {
+            if (hiveNetworks[i].chainId[pos] != *data) {
+                context->networkCandidates &= ~(1 << i);
+            }
+        }
+    }
+    if (context->state != TLV_CHAIN_ID) {
+        for (i = 0; i < HIVE_NETWORK_COUNT; i++) {
+            if (context->networkCandidates & (1 << i)) {
+                context->network = i + 1;
+                break;
+            }
+        }
+    }
+}
+
+const char *networkName(txProcessingContext_t *context) {
+    if (context->network == HIVE_NETWORK_UNKNOWN) {
+        return "Unknown";
+    }
+    return hiveNetworks[context->network - 1].name;
+}
+
 /**
  * Process Size fields that are expected to have Zero value. Except hashing the data, function
  * caches an incomming data. So, when all bytes for particulat field are received
@@ -386,6 +599,11 @@ static void processField(txProcessingContext_t *context) {
  * Throw exception if number is not '0'.
 */
 static void processZeroSizeField(txProcessingContext_t *context) {
+    if (context->currentFieldLength > sizeof(context->sizeBuffer) - 1) {
+        PRINTF("processZeroSizeField size overflow\n");
+        raiseFault(context, FAULT_FIELD_SIZE);
+    }
+
     if (context->currentFieldPos < context->currentFieldLength) {
         uint32_t length = 
             (context->commandLength <
@@ -408,7 +626,7 @@ static void processZeroSizeField(txProcessingContext_t *context) {
         unpack_variant32(context->sizeBuffer, context->currentFieldPos + 1, &sizeValue);
         if (sizeValue != 0) {
             PRINTF("zeroSizeField must be 0\n");
-            THROW(EXCEPTION);
+            raiseFault(context, FAULT_EXTENSIONS);
         }
         // Reset size buffer
         os_memset(context->sizeBuffer, 0, sizeof(context->sizeBuffer));
@@ -425,6 +643,11 @@ static void processZeroSizeField(txProcessingContext_t *context) {
  * do additional processing: Read actual number of actions encoded in buffer.
 */
 static void processActionListSizeField(txProcessingContext_t *context) {
+    if (context->currentFieldLength > sizeof(context->sizeBuffer) - 1) {
+        PRINTF("processActionListSizeField size overflow\n");
+        raiseFault(context, FAULT_FIELD_SIZE);
+    }
+
     if (context->currentFieldPos < context->currentFieldLength) {
         uint32_t length = 
             (context->commandLength <
@@ -463,7 +686,7 @@ static void processActionListSizeField(txProcessingContext_t *context) {
 static void processActionData(txProcessingContext_t *context) {
     if (context->currentFieldLength > sizeof(context->actionDataBuffer) - 1) {
         PRINTF("processActionData data overflow\n");
-        THROW(EXCEPTION);
+        raiseFault(context, FAULT_FIELD_SIZE);
     }
 
     if (context->currentFieldPos < context->currentFieldLength) {
@@ -474,10 +697,11 @@ static void processActionData(txProcessingContext_t *context) {
                 : context->currentFieldLength - context->currentFieldPos);
 
         hashTxData(context, context->workBuffer, length);
-        hashActionData(context, context->workBuffer, length);
         os_memmove(context->actionDataBuffer + context->currentFieldPos, context->workBuffer, length);
-        if(context->currentFieldPos == 0) {
-            os_memmove(&context->content->opType, context->workBuffer, sizeof(uint8_t));
+        profileCount(PROFILE_OP_BUFFER, length);
+        // a chunk may end right after the field header
+        if(context->currentFieldPos == 0 && length > 0) {
+            os_memmove(&context->staged->opType, context->workBuffer, sizeof(uint8_t));
         }
 
         context->workBuffer += length;
@@ -488,7 +712,7 @@ static void processActionData(txProcessingContext_t *context) {
     if (context->currentFieldPos == context->currentFieldLength) {
         context->currentActionDataBufferLength = context->currentFieldLength;
 
-        switch(context->content->opType) {
+        switch(context->staged->opType) {
             case 0:
                 processHiveVote(context);
                 break;
@@ -593,7 +817,7 @@ static void processActionData(txProcessingContext_t *context) {
                 break;
             default:
                 PRINTF("unknown action");
-                THROW(EXCEPTION);
+                raiseFault(context, FAULT_OP_TYPE);
         }
 
         if (++context->currentOpIndex >= context->numOperations) {
@@ -605,6 +829,20 @@ static void processActionData(txProcessingContext_t *context) {
     }
 }
 
+/**
+ * Decode every argument of the action before it is reviewed, so that an
+ * argument the screens cannot display refuses the transaction up front.
+*/
+static void checkAction(txProcessingContext_t *context) {
+    uint8_t i;
+    for (i = 0; i < (uint8_t) context->staged->argumentCount; i++) {
+        context->fault.argument = i;
+        renderArgument(i, context->staged, context->actionDataBuffer, context->currentActionDataBufferLength,
+                       PROFILE_CHECK_ARGUMENT);
+    }
+    context->fault.argument = FAULT_NO_ARGUMENT;
+}
+
 static parserStatus_e processTxInternal(txProcessingContext_t *context) {
     for(;;) {
         if (context->confirmProcessing) {
@@ -613,6 +851,8 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
         }
         if (context->actionReady) {
             context->actionReady = false;
+            checkAction(context);
+            context->actionPending = true;
             return STREAM_ACTION_READY;
         }
         if (context->state == TLV_DONE) {
@@ -626,6 +866,9 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
             bool decoded = false;
             while (context->commandLength != 0) {
                 bool valid;
+                if (context->tlvBufferPos == 0) {
+                    context->fieldOffset = currentOffset(context);
+                }
                 // Feed the TLV buffer until the length can be decoded
                 context->tlvBuffer[context->tlvBufferPos++] =
                     readTxByte(context);
@@ -635,6 +878,7 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
 
                 if (!valid) {
                     PRINTF("TLV decoding error\n");
+                    recordFault(context, FAULT_TLV);
                     return STREAM_FAULT;
                 }
                 if (decoded) {
@@ -645,6 +889,7 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
                 // Sanity check
                 if (context->tlvBufferPos == sizeof(context->tlvBuffer)) {
                     PRINTF("TLV pre-decode logic error\n");
+                    recordFault(context, FAULT_TLV);
                     return STREAM_FAULT;
                 }
             }
@@ -657,6 +902,9 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
         }
         switch (context->state) {
         case TLV_CHAIN_ID:
+            processChainIdField(context);
+            break;
+
         case TLV_HEADER_REF_BLOCK_NUM:
         case TLV_HEADER_REF_BLOCK_PREFIX:
         case TLV_HEADER_EXPITATION:
@@ -679,11 +927,23 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
 
         default:
             PRINTF("Invalid TLV decoder context\n");
+            recordFault(context, FAULT_STATE);
             return STREAM_FAULT;
         }
     }
 }
 
+/**
+ * The rest of the chunk is left unread, as if it had never been received.
+*/
+uint32_t dropTxChunk(txProcessingContext_t *context) {
+    uint32_t consumed = currentOffset(context);
+    // the next chunk starts right after what was consumed
+    context->bufferLength = consumed - context->bufferOffset;
+    context->commandLength = 0;
+    return consumed;
+}
+
 /**
  * Transaction processing should be done in a most efficient
  * way as possible, as Hive transaction size isn't fixed
@@ -734,21 +994,36 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
 */
 parserStatus_e parseTx(txProcessingContext_t *context, uint8_t *buffer, uint32_t length) {
     parserStatus_e result;
+    // the staged operation has not been taken for review yet
+    if (context->actionPending) {
+        return STREAM_ACTION_READY;
+    }
+    // An empty buffer resumes the chunk left after an action review
+    if (context->commandLength == 0) {
+        context->bufferOffset += context->bufferLength;
+        context->buffer = buffer;
+        context->bufferLength = length;
+        context->workBuffer = buffer;
+        context->commandLength = length;
+    }
 #ifdef DEBUG_APP
     // Do not catch exceptions.
-    context->workBuffer = buffer;
-    context->commandLength = length;
     result = processTxInternal(context);
 #else
     BEGIN_TRY {
         TRY {
-            if (context->commandLength == 0) {
-                context->workBuffer = buffer;
-                context->commandLength = length;
-            }
             result = processTxInternal(context);
         }
         CATCH_OTHER(e) {
+            if (context->fault.code == FAULT_NONE) {
+                // a renderer threw in checkAction(), or an unclassified fault
+                bool argument = context->fault.argument != FAULT_NO_ARGUMENT;
+                recordFault(context, argument ? FAULT_ARGUMENT : FAULT_NONE);
+                if (argument) {
+                    // the action is already counted
+                    context->fault.opIndex--;
+                }
+            }
             result = STREAM_FAULT;
         }
         FINALLY {
@@ -756,5 +1031,6 @@ parserStatus_e parseTx(txProcessingContext_t *context, uint8_t *buffer, uint32_t
     }
     END_TRY;
 #endif
+    profileCount(PROFILE_TLV_DECODE, length);
     return result;
 }
@@ -21,13 +21,14 @@
 #include "os.h"
 #include "cx.h"
 #include <stdbool.h>
+#include "hive_config.h"
 #include "hive_types.h"
 #include "hive_parse.h"
 
 typedef struct txProcessingContent_t {
     uint8_t opType;
     char argumentCount;
-    char opName[32];
+    char opName[HIVE_OP_NAME_SIZE];
     actionArgument_t arg;
 } txProcessingContent_t;
 
@@ -43,27 +44,96 @@ typedef enum txProcessingState_e {
     TLV_DONE
 } txProcessingState_e;
 
+/**
+ * Why a transaction was refused, reported with status word 0x6A80 | code.
+*/
+typedef enum txFault_e {
+    FAULT_NONE = 0x0,           // not classified, plain 0x6A80
+    FAULT_TLV = 0x1,            // field is not a DER octet string
+    FAULT_FIELD_SIZE,           // field longer than its buffer
+    FAULT_OP_TYPE,              // operation type not supported
+    FAULT_EXTENSIONS,           // non-empty transaction extensions
+    FAULT_ARGUMENT,             // operation argument cannot be decoded or displayed
+    FAULT_STATE,                // invalid decoder state
+    FAULT_NETWORK,              // unknown network selector
+    FAULT_COUNT                 // codes stay below 0x10, see SW_FAULT
+} txFault_e;
+
+typedef struct txFault_t {
+    txFault_e code;
+    uint32_t offset;            // transaction offset of the faulty field's TLV header
+    txProcessingState_e state;
+    uint32_t opIndex;
+    uint8_t argument;           // for FAULT_ARGUMENT, 0xFF otherwise
+} txFault_t;
+
+#define FAULT_NO_ARGUMENT 0xFF
+
+// SHA-256 block, transaction bytes are staged until one is complete
+#define TX_HASH_BLOCK_SIZE 64
+
+/**
+ * Networks the device knows the chain id of. The host may send the one byte
+ * selector instead of the 32 byte chain id, the stored chain id is hashed.
+ * A chain id sent in full is recognized as well, context->network is the
+ * index in hiveNetworks plus one, HIVE_NETWORK_UNKNOWN for any other chain.
+*/
+#define HIVE_CHAIN_ID_SIZE 32
+#define HIVE_NETWORK_NAME_SIZE 12
+#define HIVE_NETWORK_COUNT 2
+#define HIVE_NETWORK_UNKNOWN 0
+
+typedef struct hiveNetwork_t {
+    uint8_t selector;
+    char name[HIVE_NETWORK_NAME_SIZE];
+    uint8_t chainId[HIVE_CHAIN_ID_SIZE];
+} hiveNetwork_t;
+
+extern const hiveNetwork_t hiveNetworks[HIVE_NETWORK_COUNT];
+
+/**
+ * Byte-sized fields are kept together, the state counts towards
+ * HIVE_PARSER_RAM_BUDGET with its padding.
+*/
 typedef struct txProcessingContext_t {
     txProcessingState_e state;
     bool actionReady;
     bool confirmProcessing;
+    bool actionPending;
+    uint8_t dataAllowed;
     cx_sha256_t *sha256;
-    cx_sha256_t *dataSha256;
+    uint8_t hashBuffer[TX_HASH_BLOCK_SIZE];
     uint32_t currentFieldLength;
     uint32_t currentFieldPos;
     uint32_t currentOpIndex;
     uint32_t numOperations;
-    char currentOpType;
     uint32_t currentActionDataBufferLength;
+    char currentOpType;
     bool processingField;
     uint8_t tlvBuffer[5];
-    uint32_t tlvBufferPos;
+    uint8_t tlvBufferPos;
     uint8_t *workBuffer;
     uint32_t commandLength;
     uint8_t sizeBuffer[12];
-    uint8_t actionDataBuffer[512];
-    uint8_t dataAllowed;
-    txProcessingContent_t *content;
+    uint8_t actionDataBuffer[HIVE_OP_BUFFER_SIZE];
+    txProcessingContent_t *content;     // operation under review
+    txProcessingContent_t *staged;      // operation being buffered
+    uint8_t *reviewBuffer;
+    uint32_t reviewBufferLength;
+#if HIVE_OP_STAGING_SLOTS > 1
+    txProcessingContent_t stagedContent;
+    uint8_t reviewDataBuffer[HIVE_OP_BUFFER_SIZE];
+#endif
+    uint8_t *buffer;
+    uint32_t bufferLength;
+    uint32_t bufferOffset;
+    uint32_t fieldOffset;
+    txFault_t fault;
+    uint8_t network;
+    uint8_t networkCandidates;          // networks the chain id still matches, bit per index
+    uint8_t hashBufferPos;              // staged bytes, below TX_HASH_BLOCK_SIZE
+    cx_sha256_t *txIdSha256;            // transaction id, NULL unless requested
+    uint32_t hashedLength;              // transaction bytes handed to cx_hash
 } txProcessingContext_t;
 
 typedef enum parserStatus_e {
@@ -77,12 +147,60 @@ typedef enum parserStatus_e {
 void initTxContext(
     txProcessingContext_t *context, 
     cx_sha256_t *sha256, 
-    cx_sha256_t *dataSha256,
     txProcessingContent_t *processingContent,
     uint8_t dataAllowed
 );
 parserStatus_e parseTx(txProcessingContext_t *context, uint8_t *buffer, uint32_t length);
 
+/**
+ * Move the operation of STREAM_ACTION_READY to review, printArgument() then
+ * renders it. Until then parseTx() keeps answering STREAM_ACTION_READY.
+ * With HIVE_OP_STAGING_SLOTS > 1 parsing may go on during the review,
+ * otherwise it resumes once the review is over.
+*/
+void presentAction(txProcessingContext_t *context);
+
+/**
+ * Forget what is left of the chunk parseTx() stopped in, the host sends it
+ * again with the next one. Returns the transaction bytes consumed so far.
+*/
+uint32_t dropTxChunk(txProcessingContext_t *context);
+
+/**
+ * Hash the staged transaction bytes and write the digest, once STREAM_FINISHED.
+*/
+void hashTxFinalize(txProcessingContext_t *context, uint8_t *out, uint32_t outLength);
+
+/**
+ * Also hash the transaction without its chain id, the transaction id is the
+ * first HIVE_TX_ID_SIZE bytes of that hash. Called right after initTxContext().
+*/
+#define HIVE_TX_ID_SIZE 20
+void hashTxIdStart(txProcessingContext_t *context, cx_sha256_t *sha256);
+
+/**
+ * Write the transaction id hash (32 bytes), after hashTxFinalize().
+*/
+void hashTxIdFinalize(txProcessingContext_t *context, uint8_t *out, uint32_t outLength);
+
+/**
+ * Serialize context->fault after a STREAM_FAULT:
+ * offset (4, big endian), state (1), operation index (2, big endian), argument (1).
+*/
+uint32_t faultSerialize(txProcessingContext_t *context, uint8_t *out, uint32_t outLength);
+
 void printArgument(uint8_t argNum, txProcessingContext_t *processingContext);
 
+/**
+ * Name of the network the transaction is signed for, "Unknown" when the
+ * chain id is not one of hiveNetworks.
+*/
+const char *networkName(txProcessingContext_t *context);
+
+/**
+ * Operation types printArgument() decodes, bit (opType % 8) of byte (opType / 8).
+*/
+#define HIVE_OP_TYPE_BITMAP_SIZE 6
+extern const uint8_t supportedOpTypes[HIVE_OP_TYPE_BITMAP_SIZE];
+
 #endif // __HIVE_STREAM_H__
@@ -0,0 +1,194 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "hive_template.h"
+#include "os.h"
+
+#if HIVE_TEMPLATE_SLOTS > 0
+static uint8_t templateSlots[HIVE_TEMPLATE_SLOTS][HIVE_TEMPLATE_SIZE];
+static uint32_t templateLengths[HIVE_TEMPLATE_SLOTS];
+#endif
+
+bool templateStore(uint8_t slot, bool first, const uint8_t *data, uint32_t length) {
+#if HIVE_TEMPLATE_SLOTS > 0
+    if (slot >= HIVE_TEMPLATE_SLOTS) {
+        return false;
+    }
+    if (first) {
+        templateLengths[slot] = 0;
+    }
+    if (length > HIVE_TEMPLATE_SIZE - templateLengths[slot]) {
+        PRINTF("Template too large\n");
+        templateLengths[slot] = 0;
+        return false;
+    }
+    os_memmove(templateSlots[slot] + templateLengths[slot], data, length);
+    templateLengths[slot] += length;
+    return true;
+#else
+    UNUSED(slot);
+    UNUSED(first);
+    UNUSED(data);
+    UNUSED(length);
+    return false;
+#endif
+}
+
+/**
+ * Walk the field at dataPos and add up its content length, false when it
+ * runs past the template or the values.
+*/
+static bool scanField(const txTemplateCursor_t *cursor, uint32_t *dataPos, uint32_t *valuesPos,
+                      uint32_t *length) {
+    uint32_t parts;
+    uint32_t size;
+
+    if (*dataPos >= cursor->dataLength) {
+        return false;
+    }
+    parts = cursor->data[(*dataPos)++];
+    *length = 0;
+    while (parts-- > 0) {
+        if (*dataPos >= cursor->dataLength) {
+            return false;
+        }
+        switch (cursor->data[(*dataPos)++]) {
+        case TEMPLATE_PART_LITERAL:
+            if (*dataPos >= cursor->dataLength) {
+                return false;
+            }
+            size = cursor->data[(*dataPos)++];
+            if (size > cursor->dataLength - *dataPos) {
+                return false;
+            }
+            *dataPos += size;
+            break;
+        case TEMPLATE_PART_VALUE:
+            if (*valuesPos >= cursor->valuesLength) {
+                return false;
+            }
+            size = cursor->values[(*valuesPos)++];
+            if (size > cursor->valuesLength - *valuesPos) {
+                return false;
+            }
+            *valuesPos += size;
+            break;
+        default:
+            return false;
+        }
+        *length += size;
+    }
+    // longest length the header below encodes
+    return *length <= 0xFFFF;
+}
+
+/**
+ * DER octet string header in its shortest form, as the host encodes it.
+*/
+static uint32_t derHeader(uint8_t *out, uint32_t length) {
+    out[0] = 0x04;
+    if (length < 0x80) {
+        out[1] = length;
+        return 2;
+    }
+    if (length <= 0xFF) {
+        out[1] = 0x81;
+        out[2] = length;
+        return 3;
+    }
+    out[1] = 0x82;
+    out[2] = length >> 8;
+    out[3] = length;
+    return 4;
+}
+
+bool templateBind(txTemplateCursor_t *cursor, uint8_t *data, uint32_t dataLength,
+                  uint8_t *values, uint32_t valuesLength) {
+    uint32_t dataPos = 1;
+    uint32_t valuesPos = 0;
+    uint32_t fields;
+    uint32_t length;
+
+    os_memset(cursor, 0, sizeof(txTemplateCursor_t));
+    if (dataLength < 1) {
+        return false;
+    }
+    cursor->data = data;
+    cursor->dataLength = dataLength;
+    cursor->values = values;
+    cursor->valuesLength = valuesLength;
+    for (fields = data[0]; fields > 0; fields--) {
+        if (!scanField(cursor, &dataPos, &valuesPos, &length)) {
+            return false;
+        }
+    }
+    // every value is used, templateNext() relies on the walk above
+    if (dataPos != dataLength || valuesPos != valuesLength) {
+        return false;
+    }
+    cursor->dataPos = 1;
+    cursor->fieldsLeft = data[0];
+    return true;
+}
+
+bool templateStart(txTemplateCursor_t *cursor, uint8_t slot, uint8_t *values, uint32_t valuesLength) {
+#if HIVE_TEMPLATE_SLOTS > 0
+    if (slot < HIVE_TEMPLATE_SLOTS) {
+        return templateBind(cursor, templateSlots[slot], templateLengths[slot], values, valuesLength);
+    }
+#else
+    UNUSED(slot);
+    UNUSED(values);
+    UNUSED(valuesLength);
+#endif
+    os_memset(cursor, 0, sizeof(txTemplateCursor_t));
+    return false;
+}
+
+bool templateNext(txTemplateCursor_t *cursor, uint8_t **piece, uint32_t *length) {
+    for (;;) {
+        if (cursor->partsLeft == 0) {
+            uint32_t dataPos = cursor->dataPos;
+            uint32_t valuesPos = cursor->valuesPos;
+            uint32_t fieldLength;
+
+            if (cursor->fieldsLeft == 0) {
+                return false;
+            }
+            scanField(cursor, &dataPos, &valuesPos, &fieldLength);
+            cursor->fieldsLeft--;
+            cursor->partsLeft = cursor->data[cursor->dataPos++];
+            *piece = cursor->header;
+            *length = derHeader(cursor->header, fieldLength);
+            return true;
+        }
+        cursor->partsLeft--;
+        if (cursor->data[cursor->dataPos++] == TEMPLATE_PART_LITERAL) {
+            *length = cursor->data[cursor->dataPos++];
+            *piece = cursor->data + cursor->dataPos;
+            cursor->dataPos += *length;
+        } else {
+            *length = cursor->values[cursor->valuesPos++];
+            *piece = cursor->values + cursor->valuesPos;
+            cursor->valuesPos += *length;
+        }
+        // empty parts give nothing to parse
+        if (*length != 0) {
+            return true;
+        }
+    }
+}
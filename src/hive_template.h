@@ -0,0 +1,83 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HIVE_TEMPLATE_H__
+#define __HIVE_TEMPLATE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hive_config.h"
+
+/**
+ * Transaction templates for repeated signing requests.
+ * The host loads the transaction once, with holes where its transactions
+ * differ, and then only sends the values of the holes. The device rebuilds
+ * the DER stream the host would have sent and parses it as usual, so the
+ * digest and the review screens are the ones of the full transaction.
+ *
+ * A template holds field contents, the DER headers are rebuilt:
+ *   template := fieldCount (1) field...
+ *   field    := partCount (1) part...
+ *   part     := 00 length (1) bytes    literal field content
+ *             | 01                     next value of the signing request
+ *   values   := (length (1) bytes)...  in template order
+ *
+ * Templates live in HIVE_TEMPLATE_SLOTS slots of HIVE_TEMPLATE_SIZE bytes,
+ * in RAM until the app exits. Without slots every slot is refused.
+*/
+
+#define TEMPLATE_PART_LITERAL 0x00
+#define TEMPLATE_PART_VALUE 0x01
+
+typedef struct txTemplateCursor_t {
+    uint8_t *data;
+    uint32_t dataLength;
+    uint32_t dataPos;
+    uint8_t *values;
+    uint32_t valuesLength;
+    uint32_t valuesPos;
+    uint32_t fieldsLeft;
+    uint32_t partsLeft;
+    uint8_t header[4];          // DER header of the current field
+} txTemplateCursor_t;
+
+/**
+ * Append to a template slot, first starts it over. A template outgrowing
+ * the slot is dropped and false returned.
+*/
+bool templateStore(uint8_t slot, bool first, const uint8_t *data, uint32_t length);
+
+/**
+ * Bind the template of a slot to the values of a signing request, false
+ * when they do not fill its holes exactly.
+*/
+bool templateStart(txTemplateCursor_t *cursor, uint8_t slot, uint8_t *values, uint32_t valuesLength);
+
+/**
+ * Same as templateStart() for a template held by the caller.
+*/
+bool templateBind(txTemplateCursor_t *cursor, uint8_t *data, uint32_t dataLength,
+                  uint8_t *values, uint32_t valuesLength);
+
+/**
+ * Next piece of the transaction: a DER header, a literal or a value.
+ * Pieces point into the template, the values or the cursor and stay valid
+ * while those do. False once the transaction is complete.
+*/
+bool templateNext(txTemplateCursor_t *cursor, uint8_t **piece, uint32_t *length);
+
+#endif // __HIVE_TEMPLATE_H__
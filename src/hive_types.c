@@ -17,12 +17,13 @@
 
 #include "hive_types.h"
 #include "hive_utils.h"
+#include "hive_scratch.h"
 #include "os.h"
 #include <stdbool.h>
 #include "string.h"
 
 void append(char subject[], const char insert[], int pos) {
-    char buf[100] = {};
+    char *buf = scratchAlloc(HIVE_SCRATCH_TEMP_SIZE);
 
     strncpy(buf, subject, pos);
     int len = strlen(buf);
@@ -31,6 +32,7 @@ void append(char subject[], const char insert[], int pos) {
     strcpy(buf+len, subject+pos);
 
     strcpy(subject, buf);
+    scratchRelease(buf);
 }
 
 uint8_t asset_to_string(asset_t *asset, char *out, uint32_t size) {
@@ -38,8 +40,14 @@ uint8_t asset_to_string(asset_t *asset, char *out, uint32_t size) {
         THROW(INVALID_PARAMETER);
     }
 
-    char amountSym[sizeof(asset_t)];
-    os_memset(amountSym, 0, sizeof(asset_t));
+    // precision and symbol come from the host, an int64 has at most 19 digits
+    if (asset->precision > ASSET_MAX_PRECISION) {
+        THROW(INVALID_PARAMETER);
+    }
+
+    // sign, digits, decimal point, space, symbol
+    char amountSym[1 + ASSET_MAX_PRECISION + 2 + 1 + sizeof(asset->symbol) + 1];
+    os_memset(amountSym, 0, sizeof(amountSym));
 
     // convert asset amount to string
     i64toa(asset->amount, amountSym);
@@ -51,17 +59,24 @@ uint8_t asset_to_string(asset_t *asset, char *out, uint32_t size) {
 
     append(amountSym, ".", strlen(amountSym) - asset->precision);
     strcat(amountSym, " ");
-    strcat(amountSym, asset->symbol);
+    strncat(amountSym, asset->symbol, sizeof(symbol_t));
 
-    os_memmove(out, amountSym, sizeof(amountSym));
+    uint32_t length = strlen(amountSym);
+    if (length >= size) {
+        THROW(EXCEPTION_OVERFLOW);
+    }
+    os_memmove(out, amountSym, length + 1);
 
-    return strlen(amountSym);
+    return length;
 }
 
 uint32_t unpack_variant32(uint8_t *in, uint32_t length, variant32_t *value) {
     uint32_t i = 0;
     uint64_t v = 0; char b = 0; uint8_t by = 0;
     do {
+        if (i == length) {
+            THROW(EXCEPTION);
+        }
         b = *in; ++in; ++i;
         v |= (uint32_t)((uint8_t)b & 0x7f) << by;
         by += 7;
@@ -39,6 +39,9 @@ typedef struct asset_t {
 
 uint32_t unpack_variant32(uint8_t *in, uint32_t length, variant32_t *value);
 
+// An int64 amount has at most 19 digits
+#define ASSET_MAX_PRECISION 18
+
 uint8_t asset_to_string(asset_t *asset, char *out, uint32_t size);
 
 uint32_t public_key_to_wif(uint8_t *publicKey, uint32_t keyLength, char *out, uint32_t outLength);
@@ -16,6 +16,7 @@
 ********************************************************************************/
 
 #include "hive_utils.h"
+#include "hive_scratch.h"
 #include "os.h"
 
 
@@ -35,8 +36,7 @@ bool b58enc(uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz)
 		++zcount;
 	
 	size = (binsz - zcount) * 138 / 100 + 1;
-	uint8_t buf[size];
-	os_memset(buf, 0, size);
+	uint8_t *buf = scratchAlloc(size);
 	
 	for (i = zcount, high = size - 1; i < binsz; ++i, high = j)
 	{
@@ -57,6 +57,7 @@ bool b58enc(uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz)
 	if (*b58sz <= zcount + size - j)
 	{
 		*b58sz = zcount + size - j + 1;
+		scratchRelease(buf);
 		return false;
 	}
 	
@@ -66,6 +67,7 @@ bool b58enc(uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz)
 		b58[i] = BASE58ALPHABET[buf[j]];
 	b58[i] = '\0';
 	*b58sz = i + 1;
+	scratchRelease(buf);
 	
 	return true;
 }
@@ -77,7 +79,7 @@ void array_hexstr(char *strbuf, const void *bin, unsigned int len) {
     while (len--) {
         *strbuf++ = hex_digits[((*((char *)bin)) >> 4) & 0xF];
         *strbuf++ = hex_digits[(*((char *)bin)) & 0xF];
-        bin = (const void *)((unsigned int)bin + 1);
+        bin = (const void *)((const uint8_t *)bin + 1);
     }
     *strbuf = 0; // STM
 }
@@ -85,20 +87,13 @@ void array_hexstr(char *strbuf, const void *bin, unsigned int len) {
 char const digit[] = "0123456789";
 char* i64toa(int64_t i, char b[]) {
     char* p = b;
+    // magnitude as unsigned, negating INT64_MIN overflows
+    uint64_t u = (uint64_t)i;
     if(i<0){
         *p++ = '-';
-        i *= -1;
+        u = 0 - u;
     }
-    int64_t shifter = i;
-    do{ //Move to where representation ends
-        ++p;
-        shifter = shifter/10;
-    }while(shifter);
-    *p = '\0';
-    do{ //Move back, inserting digits as u go
-        *--p = digit[i%10];
-        i = i/10;
-    }while(i);
+    ui64toa(u, p);
     return b;
 }
 
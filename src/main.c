@@ -23,6 +23,10 @@
 #include "string.h"
 #include "hive_utils.h"
 #include "hive_stream.h"
+#include "hive_scratch.h"
+#include "hive_profile.h"
+#include "hive_stack.h"
+#include "hive_template.h"
 
 #include "glyphs.h"
 
@@ -35,10 +39,13 @@ unsigned int io_seproxyhal_touch_tx_cancel(const bagl_element_t *e);
 unsigned int io_seproxyhal_touch_address_ok(const bagl_element_t *e);
 unsigned int io_seproxyhal_touch_address_cancel(const bagl_element_t *e);
 void io_exchange_with_code(uint16_t code, uint32_t tx);
+void io_exchange_fault(void);
 void ui_idle(void);
 
 uint32_t get_public_key_and_set_result(void);
 uint32_t sign_hash_and_set_result(void);
+uint32_t fault_set_result(void);
+void tx_review_done(void);
 
 #if defined(TARGET_NANOS)
 unsigned int ui_address_nanos_button(unsigned int button_mask, unsigned int button_mask_counter);
@@ -52,12 +59,66 @@ unsigned int ui_multiple_action_tx_approval_nanos_button(unsigned int button_mas
 #define INS_GET_PUBLIC_KEY 0x02
 #define INS_SIGN 0x04
 #define INS_GET_APP_CONFIGURATION 0x06
+#define INS_LOAD_TEMPLATE 0x08
+#define INS_SIGN_TEMPLATE 0x0A
+#define INS_RESUME 0x0C
+#define INS_DRY_RUN 0x0E
+#ifdef DEBUG_APP
+#define INS_GET_PROFILE 0xF0
+#endif
+#ifdef HIVE_STACK_PROFILE
+#define INS_GET_STACK_PROFILE 0xF2
+#endif
 #define P1_CONFIRM 0x01
 #define P1_NON_CONFIRM 0x00
 #define P2_NO_CHAINCODE 0x00
 #define P2_CHAINCODE 0x01
 #define P1_FIRST 0x00
 #define P1_MORE 0x80
+#define P1_CAPABILITIES 0x01
+// P2 of the first INS_SIGN block, what comes with the signature
+#define P2_TX_ID 0x01
+#define P2_RETRY 0x02
+#define P2_RESUMABLE 0x04
+#if HIVE_SIGNATURE_CACHE_SLOTS > 0
+#define P2_SIGN_FLAGS (P2_TX_ID | P2_RETRY | P2_RESUMABLE)
+#else
+// nothing to answer a retry with
+#define P2_SIGN_FLAGS (P2_TX_ID | P2_RESUMABLE)
+#endif
+#define SESSION_TOKEN_SIZE 4
+
+// INS_RESUME status, what the host does next
+#define RESUME_SEND 0x00        // send the transaction from the offset
+#define RESUME_WAIT 0x01        // ask again, the user is reviewing
+#define RESUME_SIGNED 0x02      // the signature follows
+
+// INS_DRY_RUN P1, the rest of the rendered operation
+#define P1_DRY_RUN_NEXT 0x01
+// INS_DRY_RUN status, what the host does next
+#define DRY_RUN_SEND 0x00       // send the transaction from the offset
+#define DRY_RUN_MORE 0x01       // ask for the rest with P1_DRY_RUN_NEXT
+#define DRY_RUN_DONE 0x02       // the transaction is parsed
+// INS_DRY_RUN entries: tag, length, text, a text may span entries of its tag
+#define DRY_RUN_OPERATION 0x01
+#define DRY_RUN_LABEL 0x02
+#define DRY_RUN_VALUE 0x03
+#define DRY_RUN_DIGEST 0x04
+#define DRY_RUN_HEADER_SIZE 5
+#define DRY_RUN_RESPONSE_SIZE (sizeof(G_io_apdu_buffer) - 2)
+// operation name, then the network and every argument as label and value
+#define DRY_RUN_FIRST_ARGUMENT 3
+
+#define CAPABILITIES_VERSION 0x01
+#define INPUT_ENCODING_DER_OCTET_STRINGS 0x01
+#define PATHS_PER_SIGN 1
+
+// parser faults are reported as SW_FAULT | txFault_e
+#define SW_FAULT 0x6A80
+// outside the SW_FAULT range, so it is never read as a parser fault
+#define SW_TEMPLATE_TOO_LARGE 0x6A90
+// P2_RETRY for a transaction that was not signed in this session
+#define SW_NOT_SIGNED 0x6984
 
 #define OFFSET_CLA 0
 #define OFFSET_INS 1
@@ -79,26 +140,95 @@ typedef struct publicKeyContext_t
     bool getChaincode;
 } publicKeyContext_t;
 
+/**
+ * Where INS_DRY_RUN stands in writing out the operation parsed last.
+*/
+typedef struct dryRunCursor_t
+{
+    bool active;                    // part of the operation is not sent yet
+    uint8_t part;                   // see DRY_RUN_FIRST_ARGUMENT
+    uint16_t pos;                   // bytes of the part's text already sent
+} dryRunCursor_t;
+
 typedef struct transactionContext_t
 {
     uint8_t pathLength;
     uint32_t bip32Path[MAX_BIP32_PATH];
     uint8_t hash[32];
+    cx_sha256_t sha256;
+    cx_sha256_t txIdSha256;
+    bool returnTxId;                // P2_TX_ID, the tx id and digest follow the signature
+    bool retry;                     // P2_RETRY, signed before, operations are not reviewed
+    bool resumable;                 // P2_RESUMABLE, INS_RESUME finds the session by token
+    uint32_t token;
+    txProcessingContext_t processingContext;
+    txProcessingContent_t content;
+    parserStatus_e streamStatus;    // parser status not acted upon yet
+    bool reviewing;                 // an operation is on screen
+    bool reviewIntro;               // the introduction is on screen instead
+    bool resumeParsing;             // the rest of the chunk waits for parseTx()
+    bool replyPending;              // the last sign APDU is not answered yet
+    txTemplateCursor_t templateCursor;  // rest of a transaction signed from a template
+    dryRunCursor_t dryRun;
 } transactionContext_t;
 
-cx_sha256_t sha256;
-cx_sha256_t dataSha256;
-
+/**
+ * What the signing session waits for, see tx_stream_step().
+*/
+typedef enum txStep_e {
+    TX_STEP_WAIT,       // the user, the sign APDU stays unanswered
+    TX_STEP_IDLE,       // the host, nothing to review
+    TX_STEP_ACK,        // the host, the chunk is consumed
+    TX_STEP_SIGN,       // nothing, the transaction is reviewed
+    TX_STEP_FAULT       // nothing, the parser refused the transaction
+} txStep_e;
+
+typedef enum tmpCtxMode_e {
+    TMP_CTX_NONE = 0,
+    TMP_CTX_PUBLIC_KEY,
+    TMP_CTX_TRANSACTION,
+    TMP_CTX_DRY_RUN
+} tmpCtxMode_e;
+
+/**
+ * Public key and signing requests never run at the same time, so their state
+ * shares a single region. tmpCtxMode records which member currently owns it;
+ * a public key request in the middle of a signing session ends that session.
+*/
 union {
     publicKeyContext_t publicKeyContext;
     transactionContext_t transactionContext;
 } tmpCtx;
 
-txProcessingContext_t txProcessingCtx;
-txProcessingContent_t txContent;
+tmpCtxMode_e tmpCtxMode;
+
+/**
+ * Signatures given in this session, so that a transaction streamed again
+ * after a lost response is answered without signing it again. Written in
+ * turn, the oldest entry is replaced.
+*/
+typedef struct signatureCacheEntry_t {
+    uint8_t hash[32];
+    uint8_t pathLength;
+    uint32_t bip32Path[MAX_BIP32_PATH];
+    uint8_t signature[1 + 64];
+    uint8_t txId[HIVE_TX_ID_SIZE];  // kept when the signature was asked with P2_TX_ID
+} signatureCacheEntry_t;
+
+#if HIVE_SIGNATURE_CACHE_SLOTS > 0
+signatureCacheEntry_t signatureCache[HIVE_SIGNATURE_CACHE_SLOTS];
+uint8_t signatureCacheNext;
+#endif
+
+// Public key mode is the smaller member, the union costs nothing over signing
+_Static_assert(sizeof(publicKeyContext_t) <= sizeof(transactionContext_t), "public key context outgrew the transaction context");
+_Static_assert(sizeof(tmpCtx) == sizeof(transactionContext_t), "unexpected tmpCtx padding");
+// SW_TEMPLATE_TOO_LARGE and the other status words stay out of the fault range
+_Static_assert(FAULT_COUNT <= 0x10, "parser fault codes overflow the SW_FAULT range");
 
 volatile char actionCounter[32];
 volatile char confirmLabel[32];
+volatile char networkLabel[HIVE_NETWORK_NAME_SIZE];
 
 #ifdef TARGET_NANOX
 
@@ -330,7 +460,7 @@ const bagl_element_t ui_single_action_tx_approval_nanos[] = {
 
     {{BAGL_LABELINE, 0x02, 0, 12, 128, 32, 0, 0, 0, 0xFFFFFF, 0x000000,
       BAGL_FONT_OPEN_SANS_REGULAR_11px | BAGL_FONT_ALIGNMENT_CENTER, 0},
-     "OP Type",
+     "Network",
      0,
      0,
      0,
@@ -339,7 +469,7 @@ const bagl_element_t ui_single_action_tx_approval_nanos[] = {
      NULL},
     {{BAGL_LABELINE, 0x02, 23, 26, 82, 12, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000,
       BAGL_FONT_OPEN_SANS_EXTRABOLD_11px | BAGL_FONT_ALIGNMENT_CENTER, 26},
-     (char *)txContent.opName,
+     (char *)networkLabel,
      0,
      0,
      0,
@@ -349,7 +479,7 @@ const bagl_element_t ui_single_action_tx_approval_nanos[] = {
 
     {{BAGL_LABELINE, 0x03, 0, 12, 128, 32, 0, 0, 0, 0xFFFFFF, 0x000000,
       BAGL_FONT_OPEN_SANS_REGULAR_11px | BAGL_FONT_ALIGNMENT_CENTER, 0},
-     (char *)txContent.arg.label,
+     "OP Type",
      0,
      0,
      0,
@@ -358,7 +488,26 @@ const bagl_element_t ui_single_action_tx_approval_nanos[] = {
      NULL},
     {{BAGL_LABELINE, 0x03, 23, 26, 82, 12, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000,
       BAGL_FONT_OPEN_SANS_EXTRABOLD_11px | BAGL_FONT_ALIGNMENT_CENTER, 26},
-     (char *)txContent.arg.data,
+     (char *)tmpCtx.transactionContext.content.opName,
+     0,
+     0,
+     0,
+     NULL,
+     NULL,
+     NULL},
+
+    {{BAGL_LABELINE, 0x04, 0, 12, 128, 32, 0, 0, 0, 0xFFFFFF, 0x000000,
+      BAGL_FONT_OPEN_SANS_REGULAR_11px | BAGL_FONT_ALIGNMENT_CENTER, 0},
+     (char *)tmpCtx.transactionContext.content.arg.label,
+     0,
+     0,
+     0,
+     NULL,
+     NULL,
+     NULL},
+    {{BAGL_LABELINE, 0x04, 23, 26, 82, 12, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000,
+      BAGL_FONT_OPEN_SANS_EXTRABOLD_11px | BAGL_FONT_ALIGNMENT_CENTER, 26},
+     (char *)tmpCtx.transactionContext.content.arg.data,
      0,
      0,
      0,
@@ -372,7 +521,7 @@ unsigned int ui_single_action_tx_approval_prepro(const bagl_element_t *element)
     unsigned int display = 1;
     if (element->component.userid > 0)
     {
-        if (ux_step > 2 && element->component.userid == 3) {
+        if (ux_step > 3 && element->component.userid == 4) {
             display = 1;
         } else {
             display = (ux_step == element->component.userid - 1);
@@ -383,14 +532,15 @@ unsigned int ui_single_action_tx_approval_prepro(const bagl_element_t *element)
             {
             case 1:
             case 2:
+            case 3:
                 UX_CALLBACK_SET_INTERVAL(MAX(
                     3000, 1000 + bagl_label_roundtrip_duration_ms(element, 7)));
                 break;
 
-            case 3:
+            case 4:
                 UX_CALLBACK_SET_INTERVAL(MAX(
                     3000, 1000 + bagl_label_roundtrip_duration_ms(element, 7)));                
-                printArgument(ux_step - 2, &txProcessingCtx);
+                printArgument(ux_step - 3, &tmpCtx.transactionContext.processingContext);
                 break;
             }
         }
@@ -637,12 +787,19 @@ UX_FLOW_DEF_NOCB(
       "Review",
       confirmLabel,
     });
+UX_FLOW_DEF_NOCB(
+    ux_single_action_sign_flow_network_step,
+    bn,
+    {
+      "Network",
+      networkLabel,
+    });
 UX_FLOW_DEF_NOCB(
     ux_single_action_sign_flow_2_step,
     bn,
     {
       "OP Type",
-      txContent.opName,
+      tmpCtx.transactionContext.content.opName,
     });
 UX_STEP_INIT(
     ux_init_left_border,
@@ -659,8 +816,8 @@ UX_STEP_NOCB_INIT(
         display_next_state(STATE_VARIABLE);
     },
     {
-      .title = txContent.arg.label,
-      .text = txContent.arg.data,
+      .title = tmpCtx.transactionContext.content.arg.label,
+      .text = tmpCtx.transactionContext.content.arg.data,
     });
 
 UX_STEP_INIT(
@@ -693,6 +850,7 @@ UX_FLOW_DEF_VALID(
 UX_FLOW(
     ux_single_action_sign_flow, 
     &ux_single_action_sign_flow_1_step,
+    &ux_single_action_sign_flow_network_step,
     &ux_single_action_sign_flow_2_step,
     &ux_init_left_border,
     &ux_single_action_sign_flow_variable_step,
@@ -723,7 +881,7 @@ void display_next_state(uint8_t state)
     }
     else if (state == STATE_VARIABLE)
     {
-        printArgument(ux_step-1, &txProcessingCtx);
+        printArgument(ux_step-1, &tmpCtx.transactionContext.processingContext);
     }
     else if (state == STATE_RIGHT_BORDER)
     {
@@ -747,39 +905,7 @@ void display_next_state(uint8_t state)
 
 void ux_single_action_sign_flow_ok_pressed() 
 {
-    parserStatus_e txResult = parseTx(&txProcessingCtx, NULL, 0);
-    switch (txResult) {
-    case STREAM_ACTION_READY:
-        ux_step = 0;
-        ux_step_count = 1 + txContent.argumentCount;
-        if (txProcessingCtx.numOperations > 1) {
-            snprintf((char *)confirmLabel, sizeof(confirmLabel), "OP #%d", txProcessingCtx.currentOpIndex);
-        }
-        strcpy((char *)confirm_text1, txProcessingCtx.currentOpIndex == txProcessingCtx.numOperations ? "Sign" : "Accept");
-        strcpy((char *)confirm_text2, txProcessingCtx.currentOpIndex == txProcessingCtx.numOperations ? "transaction" : "and review next");
-
-        ux_flow_init(0, ux_single_action_sign_flow, NULL);
-        break;
-    case STREAM_PROCESSING:
-        io_exchange_with_code(0x9000, 0);
-        // Display back the original UX
-        ui_idle();
-        break;
-    case STREAM_FINISHED:
-        if(++ux_step < ux_step_count) {
-            printArgument(ux_step, &txProcessingCtx);
-            UX_REDISPLAY();
-            return 0;
-        }
-
-        io_seproxyhal_touch_tx_ok(NULL);
-        break;
-    default:
-        io_exchange_with_code(0x6A80, 0);
-        // Display back the original UX
-        ui_idle();
-        break;
-    }
+    tx_review_done();
 }
 
 
@@ -831,28 +957,7 @@ UX_FLOW(
 
 void ux_multiple_action_sign_flow_ok_pressed()
 {
-    parserStatus_e txResult = parseTx(&txProcessingCtx, NULL, 0);
-    switch (txResult) {
-    case STREAM_ACTION_READY:
-        ux_step = 0;
-        ux_step_count = txContent.argumentCount;
-        // TODO: proper redisplya
-        // UX_REDISPLAY();
-        break;
-    case STREAM_PROCESSING:
-        io_exchange_with_code(0x9000, 0);
-        // Display back the original UX
-        ui_idle();
-        break;
-    case STREAM_FINISHED:
-        io_seproxyhal_touch_tx_ok(NULL);
-        break;
-    default:
-        io_exchange_with_code(0x6A80, 0);
-        // Display back the original UX
-        ui_idle();
-        break;
-    }
+    tx_review_done();
 }
 
 #endif // #if defined(TARGET_NANOX)
@@ -926,7 +1031,13 @@ unsigned int io_seproxyhal_touch_tx_ok(const bagl_element_t *e)
 
 unsigned int io_seproxyhal_touch_tx_cancel(const bagl_element_t *e)
 {
-    io_exchange_with_code(0x6985, 0);
+    if (tmpCtxMode == TMP_CTX_TRANSACTION) {
+        // later chunks of the transaction are refused as well
+        tmpCtxMode = TMP_CTX_NONE;
+        if (tmpCtx.transactionContext.replyPending) {
+            io_exchange_with_code(0x6985, 0);
+        }
+    }
     // Display back the original UX
     ui_idle();
     return 0; // do not redraw the widget
@@ -947,35 +1058,14 @@ unsigned int ui_single_action_tx_approval_nanos_button(unsigned int button_mask,
         {
             // Proceed to next ux_step if not at end
             if(++ux_step < ux_step_count) {
-                printArgument(ux_step, &txProcessingCtx);
+                if (ux_step >= 3) {
+                    printArgument(ux_step - 3, &tmpCtx.transactionContext.processingContext);
+                }
                 UX_REDISPLAY();
                 return 0;
             }
 
-            parserStatus_e txResult = parseTx(&txProcessingCtx, NULL, 0);
-            switch (txResult) {
-            case STREAM_ACTION_READY:
-                ux_step = 0;
-                ux_step_count = 2 + txContent.argumentCount;
-                if (txProcessingCtx.numOperations > 1) {
-                    snprintf((char *)confirmLabel, sizeof(confirmLabel), "OP #%d", txProcessingCtx.currentOpIndex);
-                }
-                UX_REDISPLAY();
-                break;
-            case STREAM_PROCESSING:
-                io_exchange_with_code(0x9000, 0);
-                // Display back the original UX
-                ui_idle();
-                break;
-            case STREAM_FINISHED:
-                io_seproxyhal_touch_tx_ok(NULL);
-                break;
-            default:
-                io_exchange_with_code(0x6A80, 0);
-                // Display back the original UX
-                ui_idle();
-                break;
-            }
+            tx_review_done();
         }
         break;
 
@@ -994,27 +1084,7 @@ unsigned int ui_multiple_action_tx_approval_nanos_button(unsigned int button_mas
 
     case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
         {
-            parserStatus_e txResult = parseTx(&txProcessingCtx, NULL, 0);
-            switch (txResult) {
-            case STREAM_ACTION_READY:
-                ux_step = 0;
-                ux_step_count = txContent.argumentCount;
-                UX_REDISPLAY();
-                break;
-            case STREAM_PROCESSING:
-                io_exchange_with_code(0x9000, 0);
-                // Display back the original UX
-                ui_idle();
-                break;
-            case STREAM_FINISHED:
-                io_seproxyhal_touch_tx_ok(NULL);
-                break;
-            default:
-                io_exchange_with_code(0x6A80, 0);
-                // Display back the original UX
-                ui_idle();
-                break;
-            }
+            tx_review_done();
         }
     }
 
@@ -1030,6 +1100,11 @@ void io_exchange_with_code(uint16_t code, uint32_t tx) {
 	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
 }
 
+void io_exchange_fault(void) {
+    uint32_t tx = fault_set_result();
+    io_exchange_with_code(SW_FAULT | tmpCtx.transactionContext.processingContext.fault.code, tx);
+}
+
 unsigned short io_exchange_al(unsigned char channel, unsigned short tx_len)
 {
     switch (channel & ~(IO_FLAGS))
@@ -1112,6 +1187,7 @@ void handleGetPublicKey(uint8_t p1, uint8_t p2, uint8_t *dataBuffer,
                        (dataBuffer[2] << 8) | (dataBuffer[3]);
         dataBuffer += 4;
     }
+    tmpCtxMode = TMP_CTX_PUBLIC_KEY;
     tmpCtx.publicKeyContext.getChaincode = (p2 == P2_CHAINCODE);
     os_perso_derive_node_bip32(CX_CURVE_256K1, bip32Path, bip32PathLength,
                                privateKeyData,
@@ -1150,7 +1226,6 @@ void handleGetAppConfiguration(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
                                volatile unsigned int *flags,
                                volatile unsigned int *tx)
 {
-    UNUSED(p1);
     UNUSED(p2);
     UNUSED(workBuffer);
     UNUSED(dataLength);
@@ -1160,15 +1235,76 @@ void handleGetAppConfiguration(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
     G_io_apdu_buffer[2] = LEDGER_MINOR_VERSION;
     G_io_apdu_buffer[3] = LEDGER_PATCH_VERSION;
     *tx = 4;
+
+    // Capability block after the configuration, new fields are only appended:
+    // version, bitmap size, opType bitmap, max operation size (2),
+    // max string length (2), max BIP 32 path elements, paths per sign, input encodings,
+    // template slots, template size (2), known networks, sign flags
+    if (p1 == P1_CAPABILITIES) {
+        G_io_apdu_buffer[(*tx)++] = CAPABILITIES_VERSION;
+        G_io_apdu_buffer[(*tx)++] = HIVE_OP_TYPE_BITMAP_SIZE;
+        os_memmove(G_io_apdu_buffer + *tx, supportedOpTypes, HIVE_OP_TYPE_BITMAP_SIZE);
+        *tx += HIVE_OP_TYPE_BITMAP_SIZE;
+        // processActionData() keeps one byte of the buffer spare
+        G_io_apdu_buffer[(*tx)++] = (HIVE_OP_BUFFER_SIZE - 1) >> 8;
+        G_io_apdu_buffer[(*tx)++] = (HIVE_OP_BUFFER_SIZE - 1) & 0xFF;
+        G_io_apdu_buffer[(*tx)++] = (HIVE_ARG_DATA_SIZE - 1) >> 8;
+        G_io_apdu_buffer[(*tx)++] = (HIVE_ARG_DATA_SIZE - 1) & 0xFF;
+        G_io_apdu_buffer[(*tx)++] = MAX_BIP32_PATH;
+        G_io_apdu_buffer[(*tx)++] = PATHS_PER_SIGN;
+        G_io_apdu_buffer[(*tx)++] = INPUT_ENCODING_DER_OCTET_STRINGS;
+        G_io_apdu_buffer[(*tx)++] = HIVE_TEMPLATE_SLOTS;
+        G_io_apdu_buffer[(*tx)++] = HIVE_TEMPLATE_SIZE >> 8;
+        G_io_apdu_buffer[(*tx)++] = HIVE_TEMPLATE_SIZE & 0xFF;
+        G_io_apdu_buffer[(*tx)++] = HIVE_NETWORK_COUNT;
+        G_io_apdu_buffer[(*tx)++] = P2_SIGN_FLAGS;
+    }
     THROW(0x9000);
 }
 
-uint32_t sign_hash_and_set_result(void) 
+/**
+ * Signature given earlier in this session for the same hash and path,
+ * NULL without a signature cache.
+*/
+static signatureCacheEntry_t *signature_cache_find(void)
 {
-    // store hash
-    cx_hash(&sha256.header, CX_LAST, tmpCtx.transactionContext.hash, 0, 
-        tmpCtx.transactionContext.hash, sizeof(tmpCtx.transactionContext.hash));
+#if HIVE_SIGNATURE_CACHE_SLOTS > 0
+    uint32_t i;
+    for (i = 0; i < HIVE_SIGNATURE_CACHE_SLOTS; i++)
+    {
+        signatureCacheEntry_t *entry = &signatureCache[i];
+        if ((entry->pathLength == tmpCtx.transactionContext.pathLength) &&
+            (os_memcmp(entry->hash, tmpCtx.transactionContext.hash, sizeof(entry->hash)) == 0) &&
+            (os_memcmp(entry->bip32Path, tmpCtx.transactionContext.bip32Path,
+                       entry->pathLength * sizeof(uint32_t)) == 0))
+        {
+            return entry;
+        }
+    }
+#endif
+    return NULL;
+}
 
+static signatureCacheEntry_t *signature_cache_store(void)
+{
+#if HIVE_SIGNATURE_CACHE_SLOTS > 0
+    signatureCacheEntry_t *entry = &signatureCache[signatureCacheNext];
+    os_memmove(entry->hash, tmpCtx.transactionContext.hash, sizeof(entry->hash));
+    entry->pathLength = tmpCtx.transactionContext.pathLength;
+    os_memmove(entry->bip32Path, tmpCtx.transactionContext.bip32Path, sizeof(entry->bip32Path));
+    os_memmove(entry->signature, G_io_apdu_buffer, sizeof(entry->signature));
+    signatureCacheNext = (signatureCacheNext + 1) % HIVE_SIGNATURE_CACHE_SLOTS;
+    return entry;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * Sign the transaction hash, v r s are written at the start of the APDU buffer.
+*/
+static uint32_t sign_hash(void)
+{
     uint8_t privateKeyData[64];
     cx_ecfp_private_key_t privateKey;
     uint32_t tx = 0;
@@ -1181,6 +1317,7 @@ uint32_t sign_hash_and_set_result(void)
         tmpCtx.transactionContext.pathLength, privateKeyData, NULL);
     cx_ecfp_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
     os_memset(privateKeyData, 0, sizeof(privateKeyData));
+    profileCount(PROFILE_KEY_DERIVATION, 0);
 
     // Loop until a candidate matching the canonical signature is found
 
@@ -1194,11 +1331,13 @@ uint32_t sign_hash_and_set_result(void)
         {
             rng_rfc6979(G_io_apdu_buffer + 100, tmpCtx.transactionContext.hash, NULL, 0, SECP256K1_N, 32, V, K);
         }
+        profileCount(PROFILE_NONCE, 0);
         uint32_t infos;
         tx = cx_ecdsa_sign(&privateKey, CX_NO_CANONICAL | CX_RND_PROVIDED | CX_LAST, CX_SHA256,
                            tmpCtx.transactionContext.hash, 32, 
                            G_io_apdu_buffer + 100, 100,
                            &infos);
+        profileCount(PROFILE_ECDSA_SIGN, 0);
         if ((infos & CX_ECCINFO_PARITY_ODD) != 0)
         {
             G_io_apdu_buffer[100] |= 0x01;
@@ -1213,110 +1352,749 @@ uint32_t sign_hash_and_set_result(void)
         else
         {
             tries++;
+            profileRetry();
         }
     }
 
     os_memset(&privateKey, 0, sizeof(privateKey));
+    return tx;
+}
+
+uint32_t sign_hash_and_set_result(void) 
+{
+    signatureCacheEntry_t *entry;
+    uint32_t tx;
+
+    // store hash
+    hashTxFinalize(&tmpCtx.transactionContext.processingContext,
+                   tmpCtx.transactionContext.hash, sizeof(tmpCtx.transactionContext.hash));
+
+    entry = signature_cache_find();
+    if (entry != NULL)
+    {
+        // the response to the first request was lost
+        os_memmove(G_io_apdu_buffer, entry->signature, sizeof(entry->signature));
+        tx = sizeof(entry->signature);
+    }
+    else if (tmpCtx.transactionContext.retry)
+    {
+        // its operations were not reviewed
+        PRINTF("Transaction not signed before\n");
+        tmpCtxMode = TMP_CTX_NONE;
+        THROW(SW_NOT_SIGNED);
+    }
+    else
+    {
+        tx = sign_hash();
+        entry = signature_cache_store();
+    }
+
+    if (tmpCtx.transactionContext.returnTxId)
+    {
+        // the id is the start of its hash, the digest overwrites the rest
+        hashTxIdFinalize(&tmpCtx.transactionContext.processingContext, G_io_apdu_buffer + tx, 32);
+        // INS_RESUME answers with it if this response is lost
+        if (entry != NULL)
+        {
+            os_memmove(entry->txId, G_io_apdu_buffer + tx, sizeof(entry->txId));
+        }
+        tx += HIVE_TX_ID_SIZE;
+        os_memmove(G_io_apdu_buffer + tx, tmpCtx.transactionContext.hash, sizeof(tmpCtx.transactionContext.hash));
+        tx += sizeof(tmpCtx.transactionContext.hash);
+    }
+    profileSessionEnd();
 
     return tx;
 }
 
+/**
+ * Where the parser refused the transaction, sent with the fault status word.
+*/
+uint32_t fault_set_result()
+{
+    return faultSerialize(&tmpCtx.transactionContext.processingContext,
+                          G_io_apdu_buffer, sizeof(G_io_apdu_buffer) - 2);
+}
+
+static void tx_intro_start(void)
+{
+    snprintf((char *)actionCounter, sizeof(actionCounter), "%d operations", tmpCtx.transactionContext.processingContext.numOperations);
+#if defined(TARGET_NANOS)
+    ux_step = 0;
+    ux_step_count = 2;
+    UX_DISPLAY(ui_multiple_action_tx_approval_nanos, ui_multiple_action_tx_approval_prepro);
+#elif defined(TARGET_NANOX)
+    ux_flow_init(0, ux_multiple_action_sign_flow, NULL);
+#endif
+}
+
+static void tx_review_start(void)
+{
+    txProcessingContext_t *context = &tmpCtx.transactionContext.processingContext;
+
+    ux_step = 0;
+    ux_step_count = tmpCtx.transactionContext.content.argumentCount;
+
+    if (context->numOperations > 1) {
+        snprintf((char *)confirmLabel, sizeof(confirmLabel), "Action #%d", context->currentOpIndex);
+    } else {
+        strcpy((char *)confirmLabel, "Transaction");         
+    }
+    strcpy((char *)networkLabel, networkName(context));
+
+#if defined(TARGET_NANOS)
+    ux_step_count += 3;
+    UX_DISPLAY(ui_single_action_tx_approval_nanos, ui_single_action_tx_approval_prepro);
+#elif defined(TARGET_NANOX)
+    strcpy((char *)confirm_text1, context->currentOpIndex == context->numOperations ? "Sign" : "Accept");
+    strcpy((char *)confirm_text2, context->currentOpIndex == context->numOperations ? "transaction" : "and review next");
+    
+    ux_flow_init(0, ux_single_action_sign_flow, NULL);
+#endif
+}
+
+/**
+ * Act on the parser status until the session needs the user or the host.
+ * An operation is shown as soon as the screen is free. With two staging
+ * slots parsing goes on while it is reviewed, so the chunk can be
+ * acknowledged and the next operation streams in during the review.
+*/
+txStep_e tx_stream_step(void)
+{
+    transactionContext_t *session = &tmpCtx.transactionContext;
+    uint8_t *piece;
+    uint32_t pieceLength;
+
+    for (;;) {
+        if (session->resumeParsing) {
+            if (session->reviewing && HIVE_OP_STAGING_SLOTS == 1) {
+                // the rest of the chunk goes to the buffer under review
+                return TX_STEP_WAIT;
+            }
+            session->resumeParsing = false;
+            session->streamStatus = parseTx(&session->processingContext, NULL, 0);
+        }
+        switch (session->streamStatus) {
+        case STREAM_CONFIRM_PROCESSING:
+        case STREAM_ACTION_READY:
+            if (session->retry) {
+                // reviewed when it was signed, sign_hash_and_set_result() checks it was
+                if (session->streamStatus == STREAM_ACTION_READY) {
+                    presentAction(&session->processingContext);
+                }
+                session->resumeParsing = true;
+                break;
+            }
+            if (session->reviewing) {
+                // staged, shown once the current review is over
+                return TX_STEP_WAIT;
+            }
+            session->reviewIntro = session->streamStatus == STREAM_CONFIRM_PROCESSING;
+            if (session->reviewIntro) {
+                tx_intro_start();
+            } else {
+                presentAction(&session->processingContext);
+                tx_review_start();
+            }
+            session->reviewing = true;
+            session->resumeParsing = true;
+            break;
+        case STREAM_PROCESSING:
+            if (templateNext(&session->templateCursor, &piece, &pieceLength)) {
+                // the template goes on where the parser stopped
+                session->streamStatus = parseTx(&session->processingContext, piece, pieceLength);
+                break;
+            }
+            if (session->replyPending) {
+                return TX_STEP_ACK;
+            }
+            return session->reviewing ? TX_STEP_WAIT : TX_STEP_IDLE;
+        case STREAM_FINISHED:
+            return session->reviewing ? TX_STEP_WAIT : TX_STEP_SIGN;
+        default:
+            return TX_STEP_FAULT;
+        }
+    }
+}
+
+/**
+ * The user accepted the operation or the introduction on screen.
+*/
+void tx_review_done(void)
+{
+    transactionContext_t *session = &tmpCtx.transactionContext;
+
+    if (tmpCtxMode != TMP_CTX_TRANSACTION) {
+        // the session ended while the review was on screen
+        ui_idle();
+        return;
+    }
+    session->reviewing = false;
+    switch (tx_stream_step()) {
+    case TX_STEP_WAIT:
+        // the next operation is on screen
+        break;
+    case TX_STEP_ACK:
+        session->replyPending = false;
+        io_exchange_with_code(0x9000, 0);
+        if (!session->reviewing) {
+            // Display back the original UX
+            ui_idle();
+        }
+        break;
+    case TX_STEP_SIGN:
+        if (!session->replyPending) {
+            // INS_RESUME dropped the reply, it answers with the cached signature
+            sign_hash_and_set_result();
+            ui_idle();
+            break;
+        }
+        session->replyPending = false;
+        io_seproxyhal_touch_tx_ok(NULL);
+        break;
+    case TX_STEP_FAULT:
+        if (session->replyPending) {
+            session->replyPending = false;
+            io_exchange_fault();
+        }
+        // Display back the original UX
+        ui_idle();
+        break;
+    default:
+        // Display back the original UX
+        ui_idle();
+        break;
+    }
+}
+
+/**
+ * The transport was reset, the sign APDU it owed an answer to is gone. A
+ * resumable session waits for INS_RESUME, the rest of the chunk is dropped
+ * now as the APDU buffer gets the next commands. Other sessions end.
+*/
+static void tx_transport_reset(void)
+{
+    transactionContext_t *session = &tmpCtx.transactionContext;
+
+    if (tmpCtxMode != TMP_CTX_TRANSACTION)
+    {
+        return;
+    }
+    if (!session->resumable)
+    {
+        tmpCtxMode = TMP_CTX_NONE;
+        return;
+    }
+    session->replyPending = false;
+    if ((session->streamStatus != STREAM_FAULT) && (session->streamStatus != STREAM_FINISHED))
+    {
+        dropTxChunk(&session->processingContext);
+    }
+}
+
+/**
+ * Show the review a transport reset took off screen again, the user can
+ * still accept it while the host resumes the session.
+*/
+static void tx_review_restore(void)
+{
+    if ((tmpCtxMode != TMP_CTX_TRANSACTION) || !tmpCtx.transactionContext.reviewing)
+    {
+        return;
+    }
+    if (tmpCtx.transactionContext.reviewIntro)
+    {
+        tx_intro_start();
+    }
+    else
+    {
+        tx_review_start();
+    }
+}
+
+/**
+ * Start a signing session for the BIP 32 path at the start of the data,
+ * returns the number of bytes the path took.
+*/
+static uint32_t tx_session_start(uint8_t *workBuffer, uint16_t dataLength)
+{
+    uint32_t i;
+    if ((tmpCtxMode == TMP_CTX_TRANSACTION) && tmpCtx.transactionContext.reviewing)
+    {
+        // the previous transaction was still on screen
+        ui_idle();
+    }
+    tmpCtxMode = TMP_CTX_NONE;
+    tmpCtx.transactionContext.pathLength = workBuffer[0];
+    if ((tmpCtx.transactionContext.pathLength < 0x01) ||
+        (tmpCtx.transactionContext.pathLength > MAX_BIP32_PATH) ||
+        (dataLength < 1 + 4 * tmpCtx.transactionContext.pathLength))
+    {
+        PRINTF("Invalid path\n");
+        THROW(0x6a80);
+    }
+    workBuffer++;
+    for (i = 0; i < tmpCtx.transactionContext.pathLength; i++)
+    {
+        tmpCtx.transactionContext.bip32Path[i] =
+            (workBuffer[0] << 24) | (workBuffer[1] << 16) |
+            (workBuffer[2] << 8) | (workBuffer[3]);
+        workBuffer += 4;
+    }
+    tmpCtxMode = TMP_CTX_TRANSACTION;
+    profileReset();
+    initTxContext(&tmpCtx.transactionContext.processingContext, &tmpCtx.transactionContext.sha256,
+                  &tmpCtx.transactionContext.content, N_storage.dataAllowed);
+    tmpCtx.transactionContext.reviewing = false;
+    tmpCtx.transactionContext.reviewIntro = false;
+    tmpCtx.transactionContext.resumeParsing = false;
+    tmpCtx.transactionContext.replyPending = false;
+    tmpCtx.transactionContext.returnTxId = false;
+    tmpCtx.transactionContext.retry = false;
+    tmpCtx.transactionContext.resumable = false;
+    os_memset(&tmpCtx.transactionContext.templateCursor, 0, sizeof(txTemplateCursor_t));
+
+    return 1 + 4 * tmpCtx.transactionContext.pathLength;
+}
+
+/**
+ * Answer the sign APDU whose data was just handed to the parser.
+*/
+static void tx_stream_reply(volatile unsigned int *flags, volatile unsigned int *tx)
+{
+    tmpCtx.transactionContext.replyPending = true;
+    switch (tx_stream_step())
+    {
+    case TX_STEP_WAIT:
+        *flags |= IO_ASYNCH_REPLY;
+        break;
+    case TX_STEP_SIGN:
+        tmpCtx.transactionContext.replyPending = false;
+        *tx = sign_hash_and_set_result();
+        THROW(0x9000);
+    case TX_STEP_FAULT:
+        tmpCtx.transactionContext.replyPending = false;
+        if (tmpCtx.transactionContext.reviewing) {
+            // the staged operation was refused, end the review on screen
+            tmpCtx.transactionContext.reviewing = false;
+            ui_idle();
+        }
+        *tx = fault_set_result();
+        THROW(SW_FAULT | tmpCtx.transactionContext.processingContext.fault.code);
+    default:
+        // the chunk is consumed, a review may go on meanwhile
+        tmpCtx.transactionContext.replyPending = false;
+        THROW(0x9000);
+    }
+}
+
 void handleSign(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
                 uint16_t dataLength, volatile unsigned int *flags,
                 volatile unsigned int *tx)
 {
-    uint32_t i;
-    parserStatus_e txResult;
     if (p1 == P1_FIRST)
     {
-        tmpCtx.transactionContext.pathLength = workBuffer[0];
-        if ((tmpCtx.transactionContext.pathLength < 0x01) ||
-            (tmpCtx.transactionContext.pathLength > MAX_BIP32_PATH))
+        uint32_t pathSize;
+        uint32_t token = 0;
+        if ((p2 & ~P2_SIGN_FLAGS) != 0)
         {
-            PRINTF("Invalid path\n");
-            THROW(0x6a80);
+            THROW(0x6B00);
         }
-        workBuffer++;
-        dataLength--;
-        for (i = 0; i < tmpCtx.transactionContext.pathLength; i++)
+        if (p2 & P2_RESUMABLE)
         {
-            tmpCtx.transactionContext.bip32Path[i] =
-                (workBuffer[0] << 24) | (workBuffer[1] << 16) |
-                (workBuffer[2] << 8) | (workBuffer[3]);
-            workBuffer += 4;
-            dataLength -= 4;
+            // the token chosen by the host comes before the path
+            if (dataLength < SESSION_TOKEN_SIZE)
+            {
+                THROW(0x6a80);
+            }
+            token = U4BE(workBuffer, 0);
+            workBuffer += SESSION_TOKEN_SIZE;
+            dataLength -= SESSION_TOKEN_SIZE;
         }
-        initTxContext(&txProcessingCtx, &sha256, &dataSha256, &txContent, N_storage.dataAllowed);
+        pathSize = tx_session_start(workBuffer, dataLength);
+        workBuffer += pathSize;
+        dataLength -= pathSize;
+        if (p2 & P2_TX_ID)
+        {
+            tmpCtx.transactionContext.returnTxId = true;
+            hashTxIdStart(&tmpCtx.transactionContext.processingContext, &tmpCtx.transactionContext.txIdSha256);
+        }
+        tmpCtx.transactionContext.retry = (p2 & P2_RETRY) != 0;
+        tmpCtx.transactionContext.resumable = (p2 & P2_RESUMABLE) != 0;
+        tmpCtx.transactionContext.token = token;
     }
-    else if (p1 != P1_MORE)
+    else if ((p1 != P1_MORE) || (p2 != 0))
     {
         THROW(0x6B00);
     }
-    if (p2 != 0)
+    if ((tmpCtxMode != TMP_CTX_TRANSACTION) || (tmpCtx.transactionContext.processingContext.state == TLV_NONE))
     {
-        THROW(0x6B00);
+        PRINTF("Parser not initialized\n");
+        THROW(0x6985);
     }
-    if (txProcessingCtx.state == TLV_NONE)
+    if ((p1 == P1_MORE) && (tmpCtx.transactionContext.resumeParsing ||
+                            (tmpCtx.transactionContext.streamStatus != STREAM_PROCESSING)))
     {
-        PRINTF("Parser not initialized\n");
+        // only after INS_RESUME, the host did not wait for RESUME_SEND
+        PRINTF("Session busy\n");
         THROW(0x6985);
     }
+    profileApdu();
 
-    txResult = parseTx(&txProcessingCtx, workBuffer, dataLength);
-    switch (txResult)
+    tmpCtx.transactionContext.streamStatus =
+        parseTx(&tmpCtx.transactionContext.processingContext, workBuffer, dataLength);
+    tx_stream_reply(flags, tx);
+}
+
+#if HIVE_TEMPLATE_SLOTS > 0
+void handleLoadTemplate(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
+                        uint16_t dataLength, volatile unsigned int *flags,
+                        volatile unsigned int *tx)
+{
+    UNUSED(flags);
+    UNUSED(tx);
+    if (((p1 != P1_FIRST) && (p1 != P1_MORE)) || (p2 >= HIVE_TEMPLATE_SLOTS))
     {
-    case STREAM_CONFIRM_PROCESSING:
-        snprintf((char *)actionCounter, sizeof(actionCounter), "%d operations", txProcessingCtx.numOperations);
-#if defined(TARGET_NANOS)
-        ux_step = 0;
-        ux_step_count = 2;
-        UX_DISPLAY(ui_multiple_action_tx_approval_nanos, ui_multiple_action_tx_approval_prepro);
-#elif defined(TARGET_NANOX)
-        ux_flow_init(0, ux_multiple_action_sign_flow, NULL);
+        THROW(0x6B00);
+    }
+    if (!templateStore(p2, p1 == P1_FIRST, workBuffer, dataLength))
+    {
+        THROW(SW_TEMPLATE_TOO_LARGE);
+    }
+    THROW(0x9000);
+}
+
+/**
+ * Sign a transaction from a template: the data is the BIP 32 path followed by
+ * the values of the template holes, P2 the template slot. The transaction is
+ * then reviewed and signed as if it had been sent with INS_SIGN.
+*/
+void handleSignTemplate(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
+                        uint16_t dataLength, volatile unsigned int *flags,
+                        volatile unsigned int *tx)
+{
+    uint32_t pathSize;
+    if ((p1 != P1_FIRST) || (p2 >= HIVE_TEMPLATE_SLOTS))
+    {
+        THROW(0x6B00);
+    }
+    pathSize = tx_session_start(workBuffer, dataLength);
+    // the values stay in the APDU buffer until the APDU is answered
+    if (!templateStart(&tmpCtx.transactionContext.templateCursor, p2,
+                       workBuffer + pathSize, dataLength - pathSize))
+    {
+        PRINTF("Values do not match the template\n");
+        tmpCtxMode = TMP_CTX_NONE;
+        THROW(0x6A80);
+    }
+    profileApdu();
+
+    tmpCtx.transactionContext.streamStatus = STREAM_PROCESSING;
+    tx_stream_reply(flags, tx);
+}
 #endif
 
-        *flags |= IO_ASYNCH_REPLY;
+/**
+ * Find the signing session a transport reset cut off by its token, the data.
+ * The session kept its hash state and the operations already accepted, the
+ * host learns where to go on from:
+ * RESUME_SEND and the transaction bytes consumed (4, big endian),
+ * RESUME_WAIT and the same offset, or RESUME_SIGNED and v r s, followed by
+ * the transaction id and the digest when the session was started with P2_TX_ID.
+ * The response the session still owed the host is dropped.
+*/
+void handleResume(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
+                  uint16_t dataLength, volatile unsigned int *flags,
+                  volatile unsigned int *tx)
+{
+    transactionContext_t *session = &tmpCtx.transactionContext;
+    signatureCacheEntry_t *entry;
+    uint32_t offset;
 
-        break;
-    case STREAM_ACTION_READY:
-        ux_step = 0;
-        ux_step_count = txContent.argumentCount;
+    UNUSED(flags);
+    if ((p1 != 0) || (p2 != 0))
+    {
+        THROW(0x6B00);
+    }
+    if (dataLength != SESSION_TOKEN_SIZE)
+    {
+        THROW(0x6700);
+    }
+    if ((tmpCtxMode != TMP_CTX_TRANSACTION) || !session->resumable ||
+        (session->token != U4BE(workBuffer, 0)))
+    {
+        PRINTF("No session to resume\n");
+        THROW(0x6985);
+    }
+    if (session->streamStatus == STREAM_FAULT)
+    {
+        *tx = fault_set_result();
+        THROW(SW_FAULT | session->processingContext.fault.code);
+    }
+    session->replyPending = false;
+    if ((session->streamStatus == STREAM_FINISHED) && !session->reviewing)
+    {
+        // signed, the response may have been lost
+        entry = signature_cache_find();
+        if (entry == NULL)
+        {
+            THROW(0x6985);
+        }
+        G_io_apdu_buffer[(*tx)++] = RESUME_SIGNED;
+        os_memmove(G_io_apdu_buffer + *tx, entry->signature, sizeof(entry->signature));
+        *tx += sizeof(entry->signature);
+        if (session->returnTxId)
+        {
+            // as handleSign answers
+            os_memmove(G_io_apdu_buffer + *tx, entry->txId, sizeof(entry->txId));
+            *tx += sizeof(entry->txId);
+            os_memmove(G_io_apdu_buffer + *tx, entry->hash, sizeof(entry->hash));
+            *tx += sizeof(entry->hash);
+        }
+        THROW(0x9000);
+    }
+    // the rest of the chunk was in the APDU buffer, it is sent again
+    offset = dropTxChunk(&session->processingContext);
+    if (session->reviewing && (session->resumeParsing || (session->streamStatus != STREAM_PROCESSING)))
+    {
+        G_io_apdu_buffer[(*tx)++] = RESUME_WAIT;
+    }
+    else
+    {
+        G_io_apdu_buffer[(*tx)++] = RESUME_SEND;
+    }
+    G_io_apdu_buffer[(*tx)++] = offset >> 24;
+    G_io_apdu_buffer[(*tx)++] = offset >> 16;
+    G_io_apdu_buffer[(*tx)++] = offset >> 8;
+    G_io_apdu_buffer[(*tx)++] = offset;
+    THROW(0x9000);
+}
 
-        if (txProcessingCtx.numOperations > 1) {
-            snprintf((char *)confirmLabel, sizeof(confirmLabel), "Action #%d", txProcessingCtx.currentOpIndex);
-        } else {
-            strcpy((char *)confirmLabel, "Transaction");         
+/**
+ * Text of a part of the operation under dry run and its entry tag.
+*/
+static const char *dry_run_text(uint8_t part, uint8_t *tag)
+{
+    txProcessingContent_t *content = &tmpCtx.transactionContext.content;
+
+    switch (part)
+    {
+    case 0:
+        *tag = DRY_RUN_OPERATION;
+        return content->opName;
+    case 1:
+        *tag = DRY_RUN_LABEL;
+        return "Network";
+    case 2:
+        *tag = DRY_RUN_VALUE;
+        return networkName(&tmpCtx.transactionContext.processingContext);
+    }
+    if ((part - DRY_RUN_FIRST_ARGUMENT) % 2 == 0)
+    {
+        *tag = DRY_RUN_LABEL;
+        return content->arg.label;
+    }
+    *tag = DRY_RUN_VALUE;
+    return content->arg.data;
+}
+
+/**
+ * Write the entries of the operation under dry run after *tx, false when the
+ * response is full before the last one.
+*/
+static bool dry_run_write(volatile unsigned int *tx)
+{
+    dryRunCursor_t *cursor = &tmpCtx.transactionContext.dryRun;
+    uint32_t parts = DRY_RUN_FIRST_ARGUMENT + 2 * tmpCtx.transactionContext.content.argumentCount;
+    const char *text;
+    uint32_t length;
+    uint32_t piece;
+    uint8_t tag;
+
+    while (cursor->part < parts)
+    {
+        if ((cursor->part >= DRY_RUN_FIRST_ARGUMENT) &&
+            ((cursor->part - DRY_RUN_FIRST_ARGUMENT) % 2 == 0) && (cursor->pos == 0))
+        {
+            printArgument((cursor->part - DRY_RUN_FIRST_ARGUMENT) / 2,
+                          &tmpCtx.transactionContext.processingContext);
+        }
+        text = dry_run_text(cursor->part, &tag);
+        length = strlen(text) - cursor->pos;
+        // an entry header and some text, unless the text is empty
+        if (*tx + 2 + (length > 0 ? 1 : 0) > DRY_RUN_RESPONSE_SIZE)
+        {
+            return false;
+        }
+        piece = DRY_RUN_RESPONSE_SIZE - *tx - 2;
+        if (piece > length)
+        {
+            piece = length;
         }
+        G_io_apdu_buffer[(*tx)++] = tag;
+        G_io_apdu_buffer[(*tx)++] = piece;
+        os_memmove(G_io_apdu_buffer + *tx, text + cursor->pos, piece);
+        *tx += piece;
+        cursor->pos += piece;
+        if (piece == length)
+        {
+            cursor->part++;
+            cursor->pos = 0;
+        }
+    }
+    return true;
+}
 
-#if defined(TARGET_NANOS)
-        ux_step_count += 2;
-        UX_DISPLAY(ui_single_action_tx_approval_nanos, ui_single_action_tx_approval_prepro);
-#elif defined(TARGET_NANOX)
-        strcpy((char *)confirm_text1, txProcessingCtx.currentOpIndex == txProcessingCtx.numOperations ? "Sign" : "Accept");
-        strcpy((char *)confirm_text2, txProcessingCtx.currentOpIndex == txProcessingCtx.numOperations ? "transaction" : "and review next");
-        
-        ux_flow_init(0, ux_single_action_sign_flow, NULL);
-#endif
+/**
+ * Parse the transaction as far as the data goes and write out what the
+ * device would show, returns the status of the response.
+*/
+static uint8_t dry_run_step(volatile unsigned int *tx)
+{
+    transactionContext_t *session = &tmpCtx.transactionContext;
+    txProcessingContext_t *context = &session->processingContext;
 
-        *flags |= IO_ASYNCH_REPLY;
+    for (;;)
+    {
+        if (session->dryRun.active)
+        {
+            if (!dry_run_write(tx))
+            {
+                return DRY_RUN_MORE;
+            }
+            session->dryRun.active = false;
+            session->streamStatus = parseTx(context, NULL, 0);
+        }
+        switch (session->streamStatus)
+        {
+        case STREAM_CONFIRM_PROCESSING:
+            session->streamStatus = parseTx(context, NULL, 0);
+            break;
+        case STREAM_ACTION_READY:
+            presentAction(context);
+            // the entries overwrite the rest of the chunk, it is sent again
+            dropTxChunk(context);
+            session->dryRun.active = true;
+            session->dryRun.part = 0;
+            session->dryRun.pos = 0;
+            break;
+        case STREAM_PROCESSING:
+            return DRY_RUN_SEND;
+        case STREAM_FINISHED:
+            if (*tx + 2 + sizeof(session->hash) > DRY_RUN_RESPONSE_SIZE)
+            {
+                return DRY_RUN_MORE;
+            }
+            hashTxFinalize(context, session->hash, sizeof(session->hash));
+            G_io_apdu_buffer[(*tx)++] = DRY_RUN_DIGEST;
+            G_io_apdu_buffer[(*tx)++] = sizeof(session->hash);
+            os_memmove(G_io_apdu_buffer + *tx, session->hash, sizeof(session->hash));
+            *tx += sizeof(session->hash);
+            tmpCtxMode = TMP_CTX_NONE;
+            return DRY_RUN_DONE;
+        default:
+            tmpCtxMode = TMP_CTX_NONE;
+            *tx = fault_set_result();
+            THROW(SW_FAULT | context->fault.code);
+        }
+    }
+}
 
-        break;
-    case STREAM_FINISHED:
-        *tx = sign_hash_and_set_result();
-        THROW(0x9000);
-    case STREAM_PROCESSING:
-        THROW(0x9000);
-    case STREAM_FAULT:
-        THROW(0x6A80);
-    default:
-        PRINTF("Unexpected parser status\n");
-        THROW(0x6A80);
+/**
+ * Parse a transaction without signing it: no screen, no key. The data is
+ * streamed as with INS_SIGN, without the BIP 32 path, and every response
+ * tells how to go on (DRY_RUN_SEND, DRY_RUN_MORE or DRY_RUN_DONE), where
+ * the transaction goes on (4, big endian), then the entries of what the
+ * device would show, the operations and the digest.
+*/
+void handleDryRun(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
+                  uint16_t dataLength, volatile unsigned int *flags,
+                  volatile unsigned int *tx)
+{
+    transactionContext_t *session = &tmpCtx.transactionContext;
+    uint32_t offset;
+    uint8_t status;
+
+    UNUSED(flags);
+    if (((p1 != P1_FIRST) && (p1 != P1_MORE) && (p1 != P1_DRY_RUN_NEXT)) || (p2 != 0))
+    {
+        THROW(0x6B00);
+    }
+    if (p1 == P1_FIRST)
+    {
+        if ((tmpCtxMode == TMP_CTX_TRANSACTION) && session->reviewing)
+        {
+            // the signing session on screen ends
+            ui_idle();
+        }
+        tmpCtxMode = TMP_CTX_DRY_RUN;
+        initTxContext(&session->processingContext, &session->sha256,
+                      &session->content, N_storage.dataAllowed);
+        session->dryRun.active = false;
+    }
+    if (tmpCtxMode != TMP_CTX_DRY_RUN)
+    {
+        PRINTF("No dry run\n");
+        THROW(0x6985);
     }
+    if (p1 != P1_DRY_RUN_NEXT)
+    {
+        if (session->dryRun.active)
+        {
+            // the host did not read the whole operation
+            THROW(0x6985);
+        }
+        session->streamStatus = parseTx(&session->processingContext, workBuffer, dataLength);
+    }
+
+    *tx = DRY_RUN_HEADER_SIZE;
+    status = dry_run_step(tx);
+    offset = dropTxChunk(&session->processingContext);
+    G_io_apdu_buffer[0] = status;
+    G_io_apdu_buffer[1] = offset >> 24;
+    G_io_apdu_buffer[2] = offset >> 16;
+    G_io_apdu_buffer[3] = offset >> 8;
+    G_io_apdu_buffer[4] = offset;
+    THROW(0x9000);
 }
 
+#ifdef DEBUG_APP
+void handleGetProfile(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
+                      uint16_t dataLength,
+                      volatile unsigned int *flags,
+                      volatile unsigned int *tx)
+{
+    UNUSED(p1);
+    UNUSED(p2);
+    UNUSED(workBuffer);
+    UNUSED(dataLength);
+    UNUSED(flags);
+    *tx = profileSerialize(G_io_apdu_buffer, sizeof(G_io_apdu_buffer) - 2);
+    THROW(0x9000);
+}
+#endif // DEBUG_APP
+
+#ifdef HIVE_STACK_PROFILE
+void handleGetStackProfile(uint8_t p1, uint8_t p2, uint8_t *workBuffer,
+                           uint16_t dataLength,
+                           volatile unsigned int *flags,
+                           volatile unsigned int *tx)
+{
+    UNUSED(p1);
+    UNUSED(p2);
+    UNUSED(workBuffer);
+    UNUSED(dataLength);
+    UNUSED(flags);
+    *tx = stackProfileSerialize(G_io_apdu_buffer, sizeof(G_io_apdu_buffer) - 2);
+    THROW(0x9000);
+}
+#endif // HIVE_STACK_PROFILE
+
 void handleApdu(volatile unsigned int *flags, volatile unsigned int *tx)
 {
     unsigned short sw = 0;
+    uint8_t ins = G_io_apdu_buffer[OFFSET_INS];
+    uint32_t stackMark = stackProfileMark();
 
     BEGIN_TRY
     {
@@ -1327,6 +2105,9 @@ void handleApdu(volatile unsigned int *flags, volatile unsigned int *tx)
                 THROW(0x6E00);
             }
 
+            // Reclaim whatever an interrupted renderer left in the arena
+            scratchReset();
+
             switch (G_io_apdu_buffer[OFFSET_INS])
             {
             case INS_GET_PUBLIC_KEY:
@@ -1351,6 +2132,56 @@ void handleApdu(volatile unsigned int *flags, volatile unsigned int *tx)
                     G_io_apdu_buffer[OFFSET_LC], flags, tx);
                 break;
 
+#if HIVE_TEMPLATE_SLOTS > 0
+            case INS_LOAD_TEMPLATE:
+                handleLoadTemplate(G_io_apdu_buffer[OFFSET_P1],
+                                   G_io_apdu_buffer[OFFSET_P2],
+                                   G_io_apdu_buffer + OFFSET_CDATA,
+                                   G_io_apdu_buffer[OFFSET_LC], flags, tx);
+                break;
+
+            case INS_SIGN_TEMPLATE:
+                handleSignTemplate(G_io_apdu_buffer[OFFSET_P1],
+                                   G_io_apdu_buffer[OFFSET_P2],
+                                   G_io_apdu_buffer + OFFSET_CDATA,
+                                   G_io_apdu_buffer[OFFSET_LC], flags, tx);
+                break;
+#endif
+
+            case INS_RESUME:
+                handleResume(G_io_apdu_buffer[OFFSET_P1],
+                             G_io_apdu_buffer[OFFSET_P2],
+                             G_io_apdu_buffer + OFFSET_CDATA,
+                             G_io_apdu_buffer[OFFSET_LC], flags, tx);
+                break;
+
+            case INS_DRY_RUN:
+                handleDryRun(G_io_apdu_buffer[OFFSET_P1],
+                             G_io_apdu_buffer[OFFSET_P2],
+                             G_io_apdu_buffer + OFFSET_CDATA,
+                             G_io_apdu_buffer[OFFSET_LC], flags, tx);
+                break;
+
+#ifdef DEBUG_APP
+            case INS_GET_PROFILE:
+                handleGetProfile(
+                    G_io_apdu_buffer[OFFSET_P1],
+                    G_io_apdu_buffer[OFFSET_P2],
+                    G_io_apdu_buffer + OFFSET_CDATA,
+                    G_io_apdu_buffer[OFFSET_LC], flags, tx);
+                break;
+#endif // DEBUG_APP
+
+#ifdef HIVE_STACK_PROFILE
+            case INS_GET_STACK_PROFILE:
+                handleGetStackProfile(
+                    G_io_apdu_buffer[OFFSET_P1],
+                    G_io_apdu_buffer[OFFSET_P2],
+                    G_io_apdu_buffer + OFFSET_CDATA,
+                    G_io_apdu_buffer[OFFSET_LC], flags, tx);
+                break;
+#endif // HIVE_STACK_PROFILE
+
             default:
                 THROW(0x6D00);
                 break;
@@ -1387,6 +2218,8 @@ void handleApdu(volatile unsigned int *flags, volatile unsigned int *tx)
         }
     }
     END_TRY;
+
+    stackProfileRecordIns(ins, stackMark);
 }
 
 void sample_main(void)
@@ -1500,6 +2333,7 @@ unsigned char io_event(unsigned char channel)
         break;
 
     case SEPROXYHAL_TAG_TICKER_EVENT:
+        profileTick();
         UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {
 #if defined(TARGET_NANOS)
             if (UX_ALLOWED)
@@ -1553,6 +2387,7 @@ __attribute__((section(".boot"))) int main(void)
 
         // ensure exception will work as planned
         os_boot();
+        stackProfileInit();
 
         BEGIN_TRY
         {
@@ -1577,6 +2412,7 @@ __attribute__((section(".boot"))) int main(void)
                 USB_power(1);
 
                 ui_idle();
+                tx_review_restore();
 
 #ifdef HAVE_BLE
                 BLE_power(0, NULL);
@@ -1588,6 +2424,7 @@ __attribute__((section(".boot"))) int main(void)
             CATCH(EXCEPTION_IO_RESET)
             {
                 // reset IO and UX before continuing
+                tx_transport_reset();
                 continue;
             }
             CATCH_ALL
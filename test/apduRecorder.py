@@ -0,0 +1,379 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Records the APDUs exchanged with the device and replays them, so a slow or
+# refused signing seen with real traffic can be reproduced offline.
+#
+#   python apduRecorder.py record session.apdu signTransaction.py --file txs/tx.json
+#   python apduRecorder.py show session.apdu
+#   python apduRecorder.py replay --host session.apdu
+#   python apduRecorder.py replay --url http://127.0.0.1:5000 session.apdu
+#
+# record runs a script with every dongle ledgerblue.comm.getDongle() returns
+# wrapped in a RecordingDongle, host tools can wrap their own dongle the same
+# way. replay --host rebuilds the transactions from the sign and dry run
+# APDUs and parses them with the host library (make binding in host/),
+# replay --url sends the APDUs to a running Speculos and compares the answers.
+import argparse
+import binascii
+import os
+import struct
+import sys
+import time
+from hiveBase import Fault
+
+MAGIC = "HAPR"
+VERSION = 1
+# start and duration in microseconds, status word, command and response lengths
+RECORD = ">IIHHH"
+# no status word, the transport failed: the response holds the error
+SW_TRANSPORT = 0x0000
+
+CLA = 0xD4
+INS_SIGN = 0x04
+INS_SIGN_TEMPLATE = 0x0A
+INS_RESUME = 0x0C
+INS_DRY_RUN = 0x0E
+INS_NAMES = {
+    0x02: "public key", 0x04: "sign", 0x06: "configuration", 0x08: "load template",
+    0x0A: "sign template", 0x0C: "resume", 0x0E: "dry run", 0xF0: "profile", 0xF2: "stack profile",
+}
+P1_FIRST = 0x00
+P1_MORE = 0x80
+P2_TX_ID = 0x01
+P2_RESUMABLE = 0x04
+
+
+class Exchange:
+    def __init__(self, start, duration, command, sw, response):
+        self.start = start
+        self.duration = duration
+        self.command = command
+        self.sw = sw
+        self.response = response
+
+    def ins(self):
+        return ord(self.command[1]) if len(self.command) > 1 else None
+
+    def name(self):
+        return INS_NAMES.get(self.ins(), "ins %02X" % (self.ins() or 0))
+
+
+class Recording:
+    """ Exchanges kept in a file: the header (magic, version, start time),
+    then a record per exchange, flushed as soon as the answer is in so a
+    crashed session keeps everything up to the crash
+    """
+    def __init__(self, filename):
+        self.output = open(filename, 'wb')
+        self.start = time.time()
+        self.output.write(MAGIC + chr(VERSION) + struct.pack(">d", self.start))
+        self.output.flush()
+
+    def write(self, begin, end, command, sw, response):
+        command = str(bytearray(command))
+        response = str(bytearray(response))
+        self.output.write(struct.pack(RECORD, int((begin - self.start) * 1e6), int((end - begin) * 1e6),
+                                      sw, len(command), len(response)) + command + response)
+        self.output.flush()
+
+    def close(self):
+        self.output.close()
+
+    @staticmethod
+    def load(filename):
+        """ Returns the start time and the exchanges, a record cut short by
+        a crash is left out
+        """
+        with open(filename, 'rb') as f:
+            data = f.read()
+        if data[:4] != MAGIC or len(data) < 13 or ord(data[4]) != VERSION:
+            raise ValueError("%s is not an APDU recording" % filename)
+        start, = struct.unpack(">d", data[5:13])
+        exchanges = []
+        offset = 13
+        size = struct.calcsize(RECORD)
+        while offset + size <= len(data):
+            begin, duration, sw, commandLength, responseLength = struct.unpack(RECORD, data[offset:offset + size])
+            offset += size
+            if offset + commandLength + responseLength > len(data):
+                break
+            command = data[offset:offset + commandLength]
+            response = data[offset + commandLength:offset + commandLength + responseLength]
+            offset += commandLength + responseLength
+            exchanges.append(Exchange(begin / 1e6, duration / 1e6, command, sw, response))
+        return start, exchanges
+
+
+class RecordingDongle:
+    """ Dongle of ledgerblue.comm that writes every exchange to a recording,
+    errors are recorded and raised again
+    """
+    def __init__(self, dongle, recording):
+        self.dongle = dongle
+        self.recording = recording
+
+    def exchange(self, apdu, timeout=20000):
+        begin = time.time()
+        try:
+            response = self.dongle.exchange(apdu, timeout)
+        except Exception as e:
+            sw = getattr(e, 'sw', None)
+            if sw is not None:
+                self.recording.write(begin, time.time(), apdu, sw, getattr(e, 'data', None) or "")
+            else:
+                self.recording.write(begin, time.time(), apdu, SW_TRANSPORT, str(e))
+            raise
+        self.recording.write(begin, time.time(), apdu, 0x9000, response)
+        return response
+
+    def close(self):
+        self.dongle.close()
+
+    def __getattr__(self, name):
+        return getattr(self.dongle, name)
+
+
+def describe_sw(sw, data=None):
+    if sw == SW_TRANSPORT:
+        return "transport error"
+    if sw == 0x9000:
+        return "9000"
+    return Fault.describe(sw, data)
+
+
+class ReplayedTransaction:
+    """ Transaction streamed by sign or dry run APDUs, rebuilt from the
+    chunks at the offsets the device asked for
+    """
+    def __init__(self, kind, index):
+        self.kind = kind
+        self.first = index
+        self.exchanges = []
+        self.encoded = ""
+        self.position = 0
+        self.txId = False
+
+    def add(self, chunk):
+        self.encoded = self.encoded[:self.position] + chunk
+        self.position = len(self.encoded)
+
+    def device_time(self):
+        return sum(exchange.duration for exchange in self.exchanges)
+
+    def outcome(self):
+        last = self.exchanges[-1]
+        return last.sw, last.response
+
+
+def transactions(exchanges):
+    """ Groups the sign and dry run APDUs by transaction, other commands are
+    left out. Template signing sends values only and is not rebuilt.
+    """
+    found = []
+    current = None
+    for index, exchange in enumerate(exchanges):
+        command = bytearray(exchange.command)
+        if len(command) < 5 or command[0] != CLA:
+            continue
+        ins, p1, p2 = command[1], command[2], command[3]
+        data = str(command[5:])
+        if ins == INS_SIGN and p1 == P1_FIRST:
+            current = ReplayedTransaction("sign", index)
+            current.txId = bool(p2 & P2_TX_ID)
+            if p2 & P2_RESUMABLE:
+                data = data[4:]
+            if len(data) < 1:
+                continue
+            current.add(data[1 + 4 * ord(data[0]):])
+            found.append(current)
+        elif ins == INS_DRY_RUN and p1 == P1_FIRST:
+            current = ReplayedTransaction("dry run", index)
+            current.add(data)
+            found.append(current)
+        elif ins in (INS_SIGN, INS_DRY_RUN) and p1 == P1_MORE and current is not None:
+            current.add(data)
+        elif ins == INS_RESUME and current is not None and current.kind == "sign":
+            response = str(exchange.response)
+            if exchange.sw == 0x9000 and len(response) >= 5 and ord(response[0]) != 0x02:
+                current.position, = struct.unpack(">I", response[1:5])
+        elif ins != INS_DRY_RUN:
+            if ins == INS_SIGN_TEMPLATE:
+                print "#%d: template signing is not rebuilt" % index
+            current = None
+            continue
+        else:
+            # dry run P1 01, the rest of the entries
+            pass
+        if current is None:
+            continue
+        current.exchanges.append(exchange)
+        if ins == INS_DRY_RUN and exchange.sw == 0x9000:
+            response = str(exchange.response)
+            if len(response) >= 5 and ord(response[0]) == 0x00:
+                current.position, = struct.unpack(">I", response[1:5])
+    return found
+
+
+def replay_host(exchanges, library, dataAllowed):
+    """ Parses every recorded transaction with the host library, the answers
+    of the device are compared with it: the status word, and the digest when
+    the signature came with it. Returns the number of differences.
+    """
+    from hiveParser import HostParser, ParserFault
+
+    hostParser = HostParser(library, dataAllowed)
+    differences = 0
+    for tx in transactions(exchanges):
+        sw, response = tx.outcome()
+        begin = time.time()
+        try:
+            operations, digest = hostParser.run_encoded(tx.encoded)
+            hostSw, hostData = 0x9000, None
+        except ParserFault as e:
+            operations, digest = [], None
+            hostSw, hostData = e.sw, e.data
+        hostTime = time.time() - begin
+        print "#%d %s, %d bytes in %d APDUs, device %.1f ms, host %.3f ms" % (
+            tx.first, tx.kind, len(tx.encoded), len(tx.exchanges), tx.device_time() * 1000, hostTime * 1000)
+        print "  device: %s" % describe_sw(sw, response)
+        print "  host:   %s" % (describe_sw(hostSw, hostData) if hostSw != 0x9000 else "digest " + digest)
+        for name, arguments in operations:
+            print "    %s: %s" % (name, ", ".join("%s %s" % argument for argument in arguments))
+        if sw != SW_TRANSPORT and sw != hostSw:
+            print "  differs: status word"
+            differences += 1
+        # v r s, then the transaction id and the digest
+        elif tx.txId and sw == 0x9000 and len(response) == 65 + 20 + 32 and binascii.hexlify(response[-32:]) != digest:
+            print "  differs: digest"
+            differences += 1
+    return differences
+
+
+def replay_speculos(exchanges, url, model, delay):
+    """ Sends the recorded APDUs to Speculos in order, review screens are
+    approved. Returns the number of status words that differ, signatures
+    differ unless Speculos runs with the seed of the device.
+    """
+    from speculosBase import Approver, Speculos
+
+    speculos = Speculos(url)
+    speculos.wait_ready(30)
+    approver = Approver(speculos, model, delay)
+    approver.start()
+    differences = 0
+    recorded = {}
+    replayed = {}
+    for index, exchange in enumerate(exchanges):
+        approver.active.set()
+        begin = time.time()
+        response, sw = speculos.exchange(exchange.command)
+        elapsed = time.time() - begin
+        approver.active.clear()
+        name = exchange.name()
+        recorded[name] = recorded.get(name, 0) + exchange.duration
+        replayed[name] = replayed.get(name, 0) + elapsed
+        status = "same"
+        if exchange.sw == SW_TRANSPORT:
+            status = "recorded transport error"
+        elif sw != exchange.sw:
+            status = "differs"
+            differences += 1
+        elif response != exchange.response:
+            status = "same status, other data"
+        print "#%d %s: %s, replayed %s, %.1f ms instead of %.1f ms, %s" % (
+            index, name, describe_sw(exchange.sw, exchange.response), describe_sw(sw, response),
+            elapsed * 1000, exchange.duration * 1000, status)
+    for name in sorted(recorded):
+        print "%s: %.1f ms recorded, %.1f ms replayed" % (name, recorded[name] * 1000, replayed[name] * 1000)
+    return differences
+
+
+def record(filename, script, scriptArgs):
+    """ Runs the script with its dongles recorded
+    """
+    import runpy
+    import ledgerblue.comm
+
+    recording = Recording(filename)
+    getDongle = ledgerblue.comm.getDongle
+    ledgerblue.comm.getDongle = lambda *args, **kwargs: RecordingDongle(getDongle(*args, **kwargs), recording)
+    sys.argv = [script] + scriptArgs
+    sys.path.insert(0, os.path.dirname(os.path.abspath(script)))
+    try:
+        runpy.run_path(script, run_name='__main__')
+    finally:
+        recording.close()
+
+
+def show(exchanges):
+    for index, exchange in enumerate(exchanges):
+        print "#%d %+.3f s %s, %.1f ms: %s" % (index, exchange.start, exchange.name(),
+                                               exchange.duration * 1000, describe_sw(exchange.sw, exchange.response))
+        print "  > " + binascii.hexlify(exchange.command)
+        if exchange.sw == SW_TRANSPORT:
+            print "  ! " + exchange.response
+        elif exchange.response:
+            print "  < " + binascii.hexlify(exchange.response)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    commands = parser.add_subparsers(dest='command')
+    recordParser = commands.add_parser('record', help="Run a script and record its APDUs")
+    recordParser.add_argument('output', help="Recording to write")
+    recordParser.add_argument('script', help="Script talking to the device")
+    recordParser.add_argument('args', nargs=argparse.REMAINDER, help="Arguments of the script")
+    showParser = commands.add_parser('show', help="Print a recording")
+    showParser.add_argument('recording')
+    replayParser = commands.add_parser('replay', help="Replay a recording")
+    replayParser.add_argument('--host', action='store_true', help="Parse the transactions with the host library")
+    replayParser.add_argument('--library', help="Host build of the parser")
+    replayParser.add_argument('--no-data', action='store_true',
+                              help="Parse as with contract data not allowed on the device")
+    replayParser.add_argument('--url', help="Speculos REST API")
+    replayParser.add_argument('--model', help="Device model of Speculos, nanos or nanox")
+    replayParser.add_argument('--delay', type=float, help="Seconds between button presses")
+    replayParser.add_argument('recording')
+    args = parser.parse_args()
+
+    if args.command == 'record':
+        record(args.output, args.script, args.args)
+        exit(0)
+    start, exchanges = Recording.load(args.recording)
+    print "%s: %d exchanges recorded %s" % (args.recording, len(exchanges),
+                                           time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(start)))
+    if args.command == 'show':
+        show(exchanges)
+        exit(0)
+    if args.host:
+        if args.library is None:
+            from hiveParser import LIBRARY
+            args.library = LIBRARY
+        differences = replay_host(exchanges, args.library, not args.no_data)
+    else:
+        if args.url is None:
+            args.url = "http://127.0.0.1:5000"
+        if args.model is None:
+            args.model = "nanos"
+        if args.delay is None:
+            args.delay = 0.1
+        differences = replay_speculos(exchanges, args.url, args.model, args.delay)
+    print "%d differences" % differences
+    exit(1 if differences else 0)
@@ -0,0 +1,161 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# End-to-end signing benchmark over test/txs/ on the Speculos emulator.
+#
+# Boots bin/app.elf in Speculos (or attaches to a running instance with
+# --no-launch), signs every transaction the way signTransaction.py does while
+# a background thread approves the review screens, and writes a JSON report.
+#
+# Per transaction the report has the APDU count, bytes sent, the signature
+# and the wall time split in phases:
+#   stream - APDUs answered without user interaction (transport and parsing)
+#   review - APDUs held until the review screens were approved, this includes
+#            the signing done when the last operation is accepted
+#   total  - first APDU sent to signature received
+# With --profile (DEBUG_APP builds) it also has the cx_hash calls and bytes
+# of the signing session, as getProfile.py reads them.
+
+import argparse
+import binascii
+import glob
+import json
+import os
+import struct
+import subprocess
+import time
+from hiveBase import Transaction
+from speculosBase import Approver, Speculos
+
+CHUNK_SIZE = 255
+PROFILE_HASH = 1
+
+
+def hash_profile(speculos):
+    data, sw = speculos.exchange(binascii.unhexlify("D4F0000000"))
+    if sw != 0x9000:
+        return None
+    calls, size = struct.unpack(">II", data[1 + 8 * PROFILE_HASH:1 + 8 * (PROFILE_HASH + 1)])
+    return {"calls": calls, "bytes": size}
+
+
+def bench_file(speculos, approver, path, filename, chunkSize, profile):
+    with open(filename) as f:
+        tx = Transaction.parse(json.load(f))
+    signData = tx.encode()
+    apdus = list(tx.apdus(path, chunkSize))
+
+    report = {
+        "file": os.path.basename(filename),
+        "apdus": len(apdus),
+        "bytes_sent": sum(len(apdu) for apdu in apdus),
+        "tx_bytes": len(signData),
+        "stream_seconds": 0.0,
+        "review_seconds": 0.0,
+        "presses": 0,
+    }
+
+    start = time.time()
+    for apdu in apdus:
+        presses = approver.presses
+        approver.active.set()
+        begin = time.time()
+        data, sw = speculos.exchange(apdu)
+        elapsed = time.time() - begin
+        approver.active.clear()
+        if approver.presses != presses:
+            report["review_seconds"] += elapsed
+        else:
+            report["stream_seconds"] += elapsed
+        report["presses"] += approver.presses - presses
+        if sw != 0x9000:
+            report["status"] = "%04x" % sw
+            break
+    else:
+        report["status"] = "9000"
+        report["signature"] = binascii.hexlify(data)
+    report["total_seconds"] = time.time() - start
+    if profile:
+        report["hash"] = hash_profile(speculos)
+    return report
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--path', help="BIP 32 path to sign with")
+parser.add_argument('--txs', help="Directory with transactions in JSON format")
+parser.add_argument('--elf', help="Application binary to boot")
+parser.add_argument('--model', help="Device model, nanos or nanox")
+parser.add_argument('--speculos', help="Speculos launcher")
+parser.add_argument('--url', help="Speculos REST API")
+parser.add_argument('--no-launch', action='store_true', help="Attach to a running Speculos")
+parser.add_argument('--chunk', type=int, help="Payload bytes per APDU, up to 255")
+parser.add_argument('--delay', type=float, help="Seconds between button presses")
+parser.add_argument('--profile', action='store_true', help="Read the hash profile of DEBUG_APP builds")
+parser.add_argument('--output', help="Report file, stdout when omitted")
+args = parser.parse_args()
+
+if args.path is None:
+    args.path = "48'/13'/0'/0'/0'"
+if args.txs is None:
+    args.txs = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'txs')
+if args.elf is None:
+    args.elf = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'bin', 'app.elf')
+if args.model is None:
+    args.model = "nanos"
+if args.speculos is None:
+    args.speculos = "speculos.py"
+if args.url is None:
+    args.url = "http://127.0.0.1:5000"
+if args.chunk is None:
+    args.chunk = CHUNK_SIZE
+if args.delay is None:
+    args.delay = 0.1
+
+process = None
+if not args.no_launch:
+    port = args.url.rsplit(':', 1)[1].strip('/')
+    process = subprocess.Popen([args.speculos, args.elf, "--model", args.model,
+                                "--display", "headless", "--api-port", port])
+
+try:
+    speculos = Speculos(args.url)
+    speculos.wait_ready(30)
+    approver = Approver(speculos, args.model, args.delay)
+    approver.start()
+
+    results = []
+    for filename in sorted(glob.glob(os.path.join(args.txs, '*.json'))):
+        results.append(bench_file(speculos, approver, args.path, filename, args.chunk, args.profile))
+
+    report = {
+        "model": args.model,
+        "chunk": args.chunk,
+        "path": args.path,
+        "transactions": results,
+    }
+    output = json.dumps(report, indent=2, sort_keys=True)
+    if args.output is None:
+        print output
+    else:
+        with open(args.output, 'w') as f:
+            f.write(output + "\n")
+finally:
+    if process is not None:
+        process.terminate()
+        process.wait()
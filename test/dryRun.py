@@ -0,0 +1,56 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Parses transactions on the device without signing them and prints what
+# it would show for each one, or why it would refuse it. Nothing is shown on
+# the device and no key is used, so any number of files can be checked:
+#
+#   python dryRun.py txs/*.json
+import argparse
+import json
+from hiveBase import DryRun, Fault, Transaction
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--network', choices=sorted(Transaction.NETWORKS),
+                    help="Send the network selector instead of the chain id")
+parser.add_argument('files', nargs='+', help="Transactions in JSON format")
+args = parser.parse_args()
+
+dongle = getDongle(False)
+dryRun = DryRun(lambda apdu: dongle.exchange(bytes(apdu)))
+refused = 0
+for filename in args.files:
+    with open(filename) as f:
+        tx = Transaction.parse(json.load(f), verbose=False, network=args.network)
+    try:
+        operations, digest = dryRun.run(tx)
+    except CommException as e:
+        print "%s: refused, %s" % (filename, Fault.describe(e.sw, e.data))
+        refused += 1
+        continue
+    print "%s: digest %s%s" % (filename, digest, "" if digest == tx.digest() else ", expected " + tx.digest())
+    for index, (name, arguments) in enumerate(operations):
+        print "  operation %d: %s" % (index + 1, name)
+        for label, value in arguments:
+            print "    %s: %s" % (label, value)
+
+print "%d transactions, %d refused" % (len(args.files), refused)
+exit(1 if refused else 0)
@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Writes a seeded random transaction corpus. For every transaction:
+#   <name>.json   the transaction, as signTransaction.py --file reads it
+#   <name>.bin    the encoded transaction, as test/host reads it
+#   <name>.apdu   the sign APDUs signTransaction.py sends, one hex APDU per line
+# The same seed always gives the same corpus.
+import argparse
+import binascii
+import json
+import os
+from hiveBase import Transaction, TransactionGenerator
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--seed', type=int, default=0, help="Random seed")
+parser.add_argument('--count', type=int, default=1000, help="Number of transactions")
+parser.add_argument('--max-ops', type=int, default=8, help="Maximum operations of a mixed transaction")
+parser.add_argument('--target', choices=['nanos', 'nanox'], default='nanos', help="Device buffer sizes to fit")
+parser.add_argument('--path', help="BIP 32 path of the sign APDUs")
+parser.add_argument('--output', help="Output directory")
+args = parser.parse_args()
+
+if args.path is None:
+    args.path = "48'/13'/0'/0'/0'"
+if args.output is None:
+    args.output = 'corpus-random'
+
+if not os.path.isdir(args.output):
+    os.makedirs(args.output)
+
+if args.target == 'nanox':
+    generator = TransactionGenerator(args.seed, opBufferSize=1536, argDataSize=256)
+else:
+    generator = TransactionGenerator(args.seed)
+
+total = 0
+for name, obj in generator.corpus(args.count, args.max_ops):
+    tx = Transaction.parse(obj, verbose=False)
+    signData = tx.encode(verbose=False)
+    prefix = os.path.join(args.output, name)
+    with open(prefix + '.json', 'w') as f:
+        json.dump(obj, f, indent=2)
+    with open(prefix + '.bin', 'wb') as f:
+        f.write(signData)
+    with open(prefix + '.apdu', 'w') as f:
+        for apdu in tx.apdus(args.path):
+            f.write(binascii.hexlify(apdu) + '\n')
+    total += len(signData)
+
+print("%d transactions, %d bytes, seed %d -> %s" % (args.count, total, args.seed, args.output))
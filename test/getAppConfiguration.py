@@ -0,0 +1,91 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Reads the app configuration and capability block. With --file, tells
+# whether the device can sign the transaction without sending it.
+from ledgerblue.comm import getDongle
+import argparse
+import json
+import struct
+from hiveBase import Operation, Transaction
+
+INPUT_ENCODINGS = {0x01: "DER octet strings"}
+SIGN_FLAGS = {0x01: "transaction id", 0x02: "retry", 0x04: "resumable"}
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--file', help="Transaction in JSON format to check")
+args = parser.parse_args()
+
+dongle = getDongle(True)
+result = dongle.exchange(bytes("D406010000".decode('hex')))
+
+print "arbitrary data %s" % ("enabled" if result[0] & 0x01 else "disabled")
+print "version %d.%d.%d" % (result[1], result[2], result[3])
+if len(result) == 4:
+    # apps before the capability block ignore P1
+    print "no capability block"
+    exit(0)
+
+version = result[4]
+bitmapSize = result[5]
+bitmap = result[6:6 + bitmapSize]
+offset = 6 + bitmapSize
+maxOperation, maxString = struct.unpack(">HH", str(result[offset:offset + 4]))
+maxPathElements, pathsPerSign, encodings = result[offset + 4:offset + 7]
+templateSlots = templateSize = 0
+if len(result) >= offset + 10:
+    templateSlots = result[offset + 7]
+    templateSize, = struct.unpack(">H", str(result[offset + 8:offset + 10]))
+networks = result[offset + 10] if len(result) >= offset + 11 else 0
+signFlags = result[offset + 11] if len(result) >= offset + 12 else 0
+
+
+def supported(opType):
+    return opType < 8 * bitmapSize and (bitmap[opType / 8] & (1 << (opType % 8))) != 0
+
+
+names = dict((opType, name) for name, opType in Operation.types().items())
+print "capabilities version %d" % version
+print "operations %s" % ", ".join(names.get(opType, str(opType))
+                                  for opType in range(8 * bitmapSize) if supported(opType))
+print "max operation size %d" % maxOperation
+print "max string length %d" % maxString
+print "max path elements %d" % maxPathElements
+print "paths per sign %d" % pathsPerSign
+print "input encodings %s" % ", ".join(description for flag, description in sorted(INPUT_ENCODINGS.items())
+                                       if encodings & flag)
+print "transaction templates %d of %d bytes" % (templateSlots, templateSize)
+print "known networks %d" % networks
+print "sign flags 0x%02x %s" % (signFlags, ", ".join(description for flag, description in sorted(SIGN_FLAGS.items())
+                                                     if signFlags & flag))
+
+if args.file is not None:
+    # string lengths are checked by the device only
+    with open(args.file) as f:
+        tx = Transaction.parse(json.load(f), verbose=False)
+    problems = []
+    for index, operation in enumerate(tx.operations):
+        opType = ord(operation.data[0])
+        if not supported(opType):
+            problems.append("operation %d: %s not supported" % (index, names.get(opType, opType)))
+        elif len(operation.data) > maxOperation:
+            problems.append("operation %d: %d bytes, at most %d" % (index, len(operation.data), maxOperation))
+    for problem in problems:
+        print problem
+    print "%s: %s" % (args.file, "unsignable" if problems else "signable")
@@ -0,0 +1,42 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Reads the counters of the last signing session from a DEBUG_APP build.
+# Run signTransaction.py first.
+from ledgerblue.comm import getDongle
+import struct
+
+PHASES = ["tlv decode", "hash", "op buffer", "print argument",
+          "key derivation", "nonce", "ecdsa sign", "check argument"]
+
+dongle = getDongle(True)
+result = dongle.exchange(bytes("D4F0000000".decode('hex')))
+
+count = result[0]
+offset = 1
+for i in range(count):
+    calls, size = struct.unpack(">II", str(result[offset:offset + 8]))
+    offset += 8
+    name = PHASES[i] if i < len(PHASES) else "phase %d" % i
+    print "%-15s calls %6d bytes %8d" % (name, calls, size)
+
+retries, apdus, session = struct.unpack(">III", str(result[offset:offset + 12]))
+print "canonical retries %d" % retries
+print "apdus %d" % apdus
+print "session ticks %d" % session
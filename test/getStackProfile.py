@@ -0,0 +1,43 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Reads the stack high-water marks from a `make STACK_PROFILE=1` build.
+# Peaks accumulate until the app is restarted, run the transactions of
+# interest first.
+from ledgerblue.comm import getDongle
+from hiveBase import Operation
+import struct
+
+dongle = getDongle(True)
+result = dongle.exchange(bytes("D4F2000000".decode('hex')))
+
+stack_size, static_ram = struct.unpack(">HH", str(result[0:4]))
+print "stack size %d bytes" % stack_size
+print "static RAM %d bytes" % static_ram
+
+offset = 4
+for i in range(result[offset]):
+    ins, peak = struct.unpack(">BH", str(result[offset + 1 + i * 3:offset + 4 + i * 3]))
+    print "INS 0x%02x peak %5d bytes (%d free)" % (ins, peak, stack_size - peak)
+offset += 1 + result[offset] * 3
+
+names = dict((v, k) for k, v in Operation.types().items())
+for i in range(result[offset]):
+    op_type, peak = struct.unpack(">BH", str(result[offset + 1 + i * 3:offset + 4 + i * 3]))
+    print "%-32s peak %5d bytes (%d free)" % (names.get(op_type, str(op_type)), peak, stack_size - peak)
@@ -25,8 +25,10 @@ import datetime
 from calendar import timegm
 import struct
 from binascii import unhexlify, hexlify
-from base58 import b58decode
+from base58 import b58decode, b58encode
+from collections import OrderedDict
 import hashlib
+import random
 
 class Operation:
     def __init__(self):
@@ -78,7 +80,47 @@ class Operation:
         operations["remove_proposal"] = 46
         return operations
 
+class Fault:
+    """ Status words and data of a transaction the device refused
+    """
+    REASONS = {
+        0x6A80: "invalid data",
+        0x6A81: "field is not a DER octet string",
+        0x6A82: "field longer than the device buffer",
+        0x6A83: "operation type not supported",
+        0x6A84: "transaction extensions not empty",
+        0x6A85: "operation argument cannot be displayed",
+        0x6A86: "invalid parser state",
+        0x6A87: "unknown network selector",
+        0x6984: "transaction not signed in this session",
+        0x6A90: "template larger than its slot",
+    }
+    STATES = ["none", "chain id", "ref_block_num", "ref_block_prefix", "expiration",
+              "operation count", "operation", "extensions"]
+
+    @staticmethod
+    def describe(sw, data=None):
+        if sw not in Fault.REASONS:
+            return "status 0x%04X" % sw
+        description = "status 0x%04X, %s" % (sw, Fault.REASONS[sw])
+        if data is None or len(data) < 8:
+            return description
+        offset, state, opIndex, argument = struct.unpack(">IBHB", str(bytearray(data[:8])))
+        where = Fault.STATES[state] if state < len(Fault.STATES) else "state %d" % state
+        if where == "operation":
+            where += " %d" % opIndex
+        if argument != 0xFF:
+            where += " argument %d" % argument
+        return description + ", %s at byte %d" % (where, offset)
+
+
 class Transaction:
+    # selector the device knows the chain id of, and that chain id
+    NETWORKS = {
+        "hive": (0x01, unhexlify("beeab0de00000000000000000000000000000000000000000000000000000000")),
+        "testnet": (0x02, unhexlify("18dcf0a285365fc58b71f18b3d3fec954aa0c141c44e4e5cb4cf777b9eab274e")),
+    }
+
     def __init__(self):
         pass
 
@@ -301,6 +343,7 @@ class Transaction:
             parameters += hexlify(Transaction.parse_public_key(item[0]))
             parameters += hexlify(struct.pack("<H", item[1]))
         parameters += hexlify(Transaction.parse_public_key(data["memo_key"]))
+        parameters += hexlify(Transaction.pack_fc_uint(len(data['json_metadata'])) + data['json_metadata'])
 
         return unhexlify(parameters)
 
@@ -336,6 +379,7 @@ class Transaction:
             parameters += hexlify(Transaction.parse_public_key(item[0]))
             parameters += hexlify(struct.pack("<H", item[1]))
         parameters += hexlify(Transaction.parse_public_key(data["memo_key"]))
+        parameters += hexlify(Transaction.pack_fc_uint(len(data['json_metadata'])) + data['json_metadata'])
 
         return unhexlify(parameters)
 
@@ -404,10 +448,11 @@ class Transaction:
         parameters += hexlify(struct.pack("<h", int(data["percent_steem_dollars"])))
         parameters += "01" if data['allow_votes'] else "00"
         parameters += "01" if data['allow_curation_rewards'] else "00"
-        parameters += hexlify(struct.pack("<h", len(data.get("extensions", []))))
-        for item in data['extensions']:
+        parameters += hexlify(Transaction.pack_fc_uint(len(data.get("extensions", []))))
+        for item in data.get('extensions', []):
             if item[0] != 0:
                 raise "extension type not implemented"
+            parameters += hexlify(Transaction.pack_fc_uint(item[0]))
             parameters += hexlify(Transaction.pack_fc_uint(len(item[1]['beneficiaries'])))
             for beneficiary in item[1]['beneficiaries']:
                 parameters += hexlify(Transaction.pack_fc_uint(len(beneficiary['account'])) + beneficiary['account'])
@@ -584,6 +629,7 @@ class Transaction:
         parameters = hexlify(Transaction.pack_fc_uint(Operation.types()["set_reset_account"]))
         parameters += hexlify(Transaction.pack_fc_uint(len(data['account'])) + data['account'])
         parameters += hexlify(Transaction.pack_fc_uint(len(data['current_reset_account'])) + data['current_reset_account'])
+        parameters += hexlify(Transaction.pack_fc_uint(len(data['reset_account'])) + data['reset_account'])
 
         return unhexlify(parameters)
 
@@ -646,13 +692,17 @@ class Transaction:
         return unhexlify(parameters)
 
     @staticmethod
-    def parse(json):
+    def parse(json, verbose=True, network=None):
         tx = Transaction()
         tx.json = json
 
         # https://peakd.com/steem/@xeroc/steem-transaction-signing-in-a-nutshell
 
         tx.chain_id = unhexlify("0000000000000000000000000000000000000000000000000000000000000000")
+        tx.selector = None
+        if network is not None:
+            # the selector is sent, the chain id is hashed
+            tx.selector, tx.chain_id = Transaction.NETWORKS[network]
 
         body = json
 
@@ -671,7 +721,7 @@ class Transaction:
             data = operation[1]
             if operation[0] == 'vote':
                 parameters = Transaction.parse_vote(data)
-            if operation[0] == 'comment':
+            elif operation[0] == 'comment':
                 parameters = Transaction.parse_comment(data)
             elif operation[0] == 'transfer':
                 parameters = Transaction.parse_transfer(data)
@@ -738,8 +788,7 @@ class Transaction:
             elif operation[0] == 'remove_proposal':
                 parameters = Transaction.parse_remove_proposal(data)
             else:
-                print("operation type not implemented")
-                exit()
+                raise ValueError("operation type not implemented: %s" % operation[0])
 
             op.data = parameters
 
@@ -748,37 +797,619 @@ class Transaction:
         for operation in tx.operations:
             sha = hashlib.sha256()
             sha.update(operation.data)
-            print 'Argument checksum ' + sha.hexdigest()
+            if verbose:
+                print 'Argument checksum ' + sha.hexdigest()
 
 
         tx.extensions_size = struct.pack("<h", len(body.get('extensions', [])))
 
         return tx
 
-    def encode(self):
-        encoder = Encoder()
+    def fields(self, wire=False):
+        """ Transaction fields in signing order, each one is sent as a DER OctetString.
+        With wire, the chain id is the network selector when there is one.
+        """
+        if wire and self.selector is not None:
+            yield chr(self.selector)
+        else:
+            yield self.chain_id
+        yield self.ref_block_num
+        yield self.ref_block_prefix
+        yield self.expiration
+        yield self.operations_count
+        for operation in self.operations:
+            yield operation.data
+        yield self.extensions_size
+
+    def digest(self):
         sha = hashlib.sha256()
+        for field in self.fields():
+            sha.update(field)
+        return sha.hexdigest()
 
-        sha.update(self.chain_id)
-        sha.update(self.ref_block_num)
-        sha.update(self.ref_block_prefix)
-        sha.update(self.expiration)
-        sha.update(self.operations_count)
-        for operation in self.operations:
-            sha.update(operation.data)
-        sha.update(self.extensions_size)
+    def tx_id(self):
+        """ Hive transaction id, the hash of every field but the chain id
+        """
+        sha = hashlib.sha256()
+        for field in list(self.fields())[1:]:
+            sha.update(field)
+        return sha.hexdigest()[:40]
 
-        print 'Signing digest ' + sha.hexdigest()
+    def encode(self, verbose=True):
+        encoder = Encoder()
 
-        encoder.start()
-        encoder.write(self.chain_id, Numbers.OctetString)
-        encoder.write(self.ref_block_num, Numbers.OctetString)
-        encoder.write(self.ref_block_prefix, Numbers.OctetString)
-        encoder.write(self.expiration, Numbers.OctetString)
+        if verbose:
+            print 'Signing digest ' + self.digest()
 
-        encoder.write(self.operations_count, Numbers.OctetString)
-        for operation in self.operations:
-            encoder.write(operation.data, Numbers.OctetString)
-        encoder.write(self.extensions_size, Numbers.OctetString)
+        encoder.start()
+        for field in self.fields(wire=True):
+            encoder.write(field, Numbers.OctetString)
 
         return encoder.output()
+
+    @staticmethod
+    def der_header(length):
+        """ OctetString tag and length, as asn1.Encoder writes them
+        """
+        if length < 0x80:
+            return chr(Numbers.OctetString) + chr(length)
+        encoded = ''
+        while length:
+            encoded = chr(length & 0xff) + encoded
+            length >>= 8
+        return chr(Numbers.OctetString) + chr(0x80 | len(encoded)) + encoded
+
+    @staticmethod
+    def parse_bip32_path(path):
+        if len(path) == 0:
+            return ""
+        result = ""
+        elements = path.split('/')
+        for pathElement in elements:
+            element = pathElement.split('\'')
+            if len(element) == 1:
+                result = result + struct.pack(">I", int(element[0]))
+            else:
+                result = result + struct.pack(">I", 0x80000000 | int(element[0]))
+        return result
+
+    def apdus(self, path, maxPayload=255, flags=0, token=None):
+        """ Yields the sign APDUs of the transaction, each one filled up to
+        maxPayload bytes: the first one with the BIP 32 path and the sign flags
+        in P2, then P1_MORE ones. With a session token the session can be
+        resumed (flag 04).
+        Fields are DER encoded as they are framed, the whole encoding is never built.
+        """
+        donglePath = Transaction.parse_bip32_path(path)
+        payload = chr(len(donglePath) / 4) + donglePath
+        if token is not None:
+            flags |= 0x04
+            payload = struct.pack(">I", token) + payload
+        header = "D40400".decode('hex') + chr(flags)
+        for field in self.fields(wire=True):
+            for data in (Transaction.der_header(len(field)), field):
+                offset = 0
+                while offset < len(data):
+                    length = min(maxPayload - len(payload), len(data) - offset)
+                    payload += data[offset: offset + length]
+                    offset += length
+                    if len(payload) == maxPayload:
+                        yield header + chr(len(payload)) + payload
+                        header = "D4048000".decode('hex')
+                        payload = ''
+        if payload:
+            yield header + chr(len(payload)) + payload
+
+    def apdus_from(self, offset, maxPayload=255):
+        """ Yields the P1_MORE sign APDUs of the transaction from offset on,
+        where a resumed session goes on
+        """
+        encoded = self.encode(verbose=False)
+        for start in range(offset, len(encoded), maxPayload):
+            chunk = encoded[start:start + maxPayload]
+            yield "D4048000".decode('hex') + chr(len(chunk)) + chunk
+
+    RESUME_SEND = 0x00
+    RESUME_WAIT = 0x01
+    RESUME_SIGNED = 0x02
+
+    @staticmethod
+    def resume_apdu(token):
+        """ Asks where the signing session of that token stands: status,
+        then the offset to go on from or the signature
+        """
+        return "D40C0000".decode('hex') + chr(4) + struct.pack(">I", token)
+
+
+class DryRun:
+    """ Transactions parsed by the device without signing them (INS 0x0E):
+    what the device would show for every operation, and the digest.
+    """
+    SEND = 0x00
+    MORE = 0x01
+    DONE = 0x02
+    OPERATION = 0x01
+    LABEL = 0x02
+    VALUE = 0x03
+    DIGEST = 0x04
+
+    def __init__(self, exchange):
+        """ exchange sends an APDU and returns the response data
+        """
+        self.exchange = exchange
+
+    def run(self, tx, maxPayload=255):
+        """ Returns the operations, each one (name, [(label, value)...]),
+        and the digest. Refused transactions raise what exchange raises.
+        """
+        encoded = tx.encode(verbose=False)
+        entries = []
+        offset = 0
+        p1 = 0x00
+        status = DryRun.SEND
+        while status != DryRun.DONE:
+            if status == DryRun.SEND:
+                if offset >= len(encoded) and p1 != 0x00:
+                    raise ValueError("the transaction ended before the device was done")
+                chunk = encoded[offset:offset + maxPayload]
+                response = self.exchange("D40E".decode('hex') + chr(p1) + "\x00" + chr(len(chunk)) + chunk)
+                p1 = 0x80
+            else:
+                response = self.exchange("D40E0100".decode('hex') + "\x00")
+            response = str(bytearray(response))
+            status = ord(response[0])
+            offset, = struct.unpack(">I", response[1:5])
+            entries += DryRun.entries(response[5:])
+        return DryRun.operations(entries)
+
+    @staticmethod
+    def entries(data):
+        """ (tag, text) of the response entries, a text split over several
+        entries of its tag is joined
+        """
+        entries = []
+        while data:
+            tag, length = ord(data[0]), ord(data[1])
+            text = data[2:2 + length]
+            data = data[2 + length:]
+            entries.append((tag, text))
+        return entries
+
+    @staticmethod
+    def operations(entries):
+        joined = []
+        for tag, text in entries:
+            if joined and joined[-1][0] == tag:
+                joined[-1] = (tag, joined[-1][1] + text)
+            else:
+                joined.append((tag, text))
+        operations = []
+        digest = None
+        label = None
+        for tag, text in joined:
+            if tag == DryRun.OPERATION:
+                operations.append((text, []))
+            elif tag == DryRun.LABEL:
+                label = text
+            elif tag == DryRun.VALUE:
+                operations[-1][1].append((label, text))
+            elif tag == DryRun.DIGEST:
+                digest = hexlify(text)
+        return operations, digest
+
+
+class Template:
+    """ Transaction skeleton kept by the device in a template slot (INS 0x08),
+    transactions of its shape are then signed by sending the values of its
+    holes only (INS 0x0A).
+
+    Built from sample transactions: what every sample shares at the start
+    and at the end of a field is literal, the bytes in between are the hole
+    of that field. ref_block_num, ref_block_prefix and expiration are always
+    holes.
+    """
+    PART_LITERAL = 0x00
+    PART_VALUE = 0x01
+    HEADER_FIELDS = (1, 2, 3)
+
+    def __init__(self, fields):
+        """ fields: (prefix, suffix, hole) for every transaction field
+        """
+        self.fields = fields
+
+    @staticmethod
+    def from_transactions(txs):
+        samples = [list(tx.fields(wire=True)) for tx in txs]
+        if len(set(len(fields) for fields in samples)) != 1:
+            raise ValueError("samples have different operation counts")
+        fields = []
+        for index, contents in enumerate(zip(*samples)):
+            if index in Template.HEADER_FIELDS:
+                fields.append(('', '', True))
+            elif len(set(contents)) == 1:
+                fields.append((contents[0], '', False))
+            else:
+                shortest = min(len(content) for content in contents)
+                prefix = 0
+                while prefix < shortest and len(set(content[prefix] for content in contents)) == 1:
+                    prefix += 1
+                suffix = 0
+                while suffix < shortest - prefix and len(set(content[-1 - suffix] for content in contents)) == 1:
+                    suffix += 1
+                first = contents[0]
+                fields.append((first[:prefix], first[len(first) - suffix:], True))
+        return Template(fields)
+
+    @staticmethod
+    def literal(data):
+        parts = []
+        for offset in range(0, len(data), 255):
+            chunk = data[offset:offset + 255]
+            parts.append(chr(Template.PART_LITERAL) + chr(len(chunk)) + chunk)
+        return parts
+
+    def encode(self):
+        if len(self.fields) > 255:
+            raise ValueError("%d fields, a template holds 255" % len(self.fields))
+        encoded = chr(len(self.fields))
+        for prefix, suffix, hole in self.fields:
+            parts = Template.literal(prefix)
+            if hole:
+                parts.append(chr(Template.PART_VALUE))
+            parts += Template.literal(suffix)
+            encoded += chr(len(parts)) + ''.join(parts)
+        return encoded
+
+    def values(self, tx):
+        """ Values of the holes for tx, ValueError when tx does not fit the template
+        """
+        values = ''
+        contents = list(tx.fields(wire=True))
+        if len(contents) != len(self.fields):
+            raise ValueError("%d fields, the template has %d" % (len(contents), len(self.fields)))
+        for index, (content, (prefix, suffix, hole)) in enumerate(zip(contents, self.fields)):
+            if not hole:
+                if content != prefix:
+                    raise ValueError("field %d differs from the template" % index)
+                continue
+            if (len(content) < len(prefix) + len(suffix) or not content.startswith(prefix) or
+                    not content.endswith(suffix)):
+                raise ValueError("field %d differs from the template around its hole" % index)
+            value = content[len(prefix):len(content) - len(suffix)]
+            if len(value) > 255:
+                raise ValueError("field %d: hole of %d bytes, at most 255" % (index, len(value)))
+            values += chr(len(value)) + value
+        return values
+
+    def rebuild(self, values):
+        """ Transaction fields as the device rebuilds them from the values, as sent
+        """
+        fields = []
+        for prefix, suffix, hole in self.fields:
+            value = ''
+            if hole:
+                length = ord(values[0])
+                value = values[1:1 + length]
+                values = values[1 + length:]
+            fields.append(prefix + value + suffix)
+        return fields
+
+    def apdus(self, slot, maxPayload=255):
+        """ Yields the APDUs loading the template into a slot
+        """
+        encoded = self.encode()
+        p1 = 0x00
+        for offset in range(0, len(encoded), maxPayload):
+            chunk = encoded[offset:offset + maxPayload]
+            yield "D408".decode('hex') + chr(p1) + chr(slot) + chr(len(chunk)) + chunk
+            p1 = 0x80
+
+    def sign_apdu(self, tx, path, slot):
+        donglePath = Transaction.parse_bip32_path(path)
+        payload = chr(len(donglePath) / 4) + donglePath + self.values(tx)
+        if len(payload) > 255:
+            raise ValueError("%d bytes of path and values, an APDU holds 255" % len(payload))
+        return "D40A00".decode('hex') + chr(slot) + chr(len(payload)) + payload
+
+
+class TransactionGenerator:
+    """ Seeded random transactions in the JSON format Transaction.parse reads.
+
+    Every operation stays within the limits of the device parser: strings fit
+    the argument buffer and the encoded operation fits the operation buffer.
+    Profiles shape the operations:
+      typical  short strings and lists of a few entries
+      long     strings close to the argument buffer size
+      deep     authority, beneficiary and account lists as long as they fit
+    """
+    PROFILES = ["typical", "long", "deep"]
+
+    ACCOUNT_CHARS = "abcdefghijklmnopqrstuvwxyz0123456789"
+    PERMLINK_CHARS = ACCOUNT_CHARS + "-"
+    TEXT_CHARS = ACCOUNT_CHARS + "ABCDEFGHIJKLMNOPQRSTUVWXYZ .,:;!?-_/#@"
+
+    # 2016-03-24 (genesis) .. 2030-01-01
+    TIME_RANGE = (1458777600, 1893456000)
+
+    def __init__(self, seed=0, opBufferSize=640, argDataSize=128):
+        """ opBufferSize and argDataSize follow HIVE_OP_BUFFER_SIZE and
+        HIVE_ARG_DATA_SIZE of the target (Nano S: 640 and 128)
+        """
+        self.random = random.Random(seed)
+        self.opBufferSize = opBufferSize
+        self.argDataSize = argDataSize
+        self.profile = "typical"
+        self.maxStringLength = argDataSize - 1
+        self.maxListLength = 127
+
+    @staticmethod
+    def operations():
+        """ Operations Transaction.parse is able to encode, by operation type
+        """
+        types = Operation.types()
+        names = [name for name in types if hasattr(Transaction, 'parse_' + name)]
+        return sorted(names, key=lambda name: types[name])
+
+    def string(self, chars, minLength=0):
+        if self.profile == "long":
+            length = self.random.randint(max(minLength, self.maxStringLength * 3 / 4), self.maxStringLength)
+        else:
+            length = self.random.randint(minLength, min(self.maxStringLength, 32))
+        return ''.join(self.random.choice(chars) for i in range(length))
+
+    def text(self):
+        return self.string(self.TEXT_CHARS)
+
+    def permlink(self):
+        return self.string(self.PERMLINK_CHARS, 1)
+
+    def account(self):
+        """ Hive account names are 3 to 16 characters starting with a letter
+        """
+        length = 16 if self.profile == "long" else self.random.randint(3, 16)
+        name = self.random.choice(self.ACCOUNT_CHARS[:26])
+        return name + ''.join(self.random.choice(self.ACCOUNT_CHARS) for i in range(length - 1))
+
+    def accounts(self, count):
+        """ Sorted and unique, as flat_set<account_name_type> is serialized
+        """
+        names = set()
+        while len(names) < count:
+            names.add(self.account())
+        return sorted(names)
+
+    def count(self, limit=None):
+        limit = min(limit or self.maxListLength, self.maxListLength)
+        if self.profile == "deep":
+            return self.random.randint(max(1, limit / 2), limit)
+        return self.random.randint(0, min(limit, 3))
+
+    def flag(self):
+        return self.random.random() < 0.5
+
+    def uint16(self, limit=0xffff):
+        return self.random.randint(0, limit)
+
+    def uint32(self):
+        return self.random.randint(0, 0xffffffff)
+
+    def asset(self, symbol):
+        precision = Transaction.symbol_precision(symbol)
+        # stay well inside the exact range of the float Transaction.parse_asset goes through
+        amount = self.random.choice([0, self.random.randint(1, 10 ** precision), self.random.randint(1, 10 ** 12)])
+        return "%d.%0*d %s" % (amount / 10 ** precision, precision, amount % 10 ** precision, symbol)
+
+    def public_key(self):
+        key = chr(self.random.choice([2, 3])) + ''.join(chr(self.random.randint(0, 255)) for i in range(32))
+        ripemd = hashlib.new('ripemd160')
+        ripemd.update(key)
+        return "STM" + b58encode(key + ripemd.digest()[:4])
+
+    def timestamp(self):
+        return time.strftime("%Y-%m-%dT%H:%M:%S", time.gmtime(self.random.randint(*self.TIME_RANGE)))
+
+    def authority(self):
+        """ account_auths and key_auths are flat_maps, sorted by key
+        """
+        accounts = self.accounts(self.count())
+        keys = sorted(set(self.public_key() for i in range(self.count())),
+                      key=lambda key: Transaction.parse_public_key(key))
+        authority = OrderedDict()
+        authority["weight_threshold"] = self.random.randint(1, 10)
+        authority["account_auths"] = [[account, self.random.randint(1, 10)] for account in accounts]
+        authority["key_auths"] = [[key, self.random.randint(1, 10)] for key in keys]
+        return authority
+
+    def op_vote(self):
+        return OrderedDict([("voter", self.account()), ("author", self.account()),
+                            ("permlink", self.permlink()), ("weight", self.random.randint(-10000, 10000))])
+
+    def op_comment(self):
+        parent = self.flag()
+        return OrderedDict([("parent_author", self.account() if parent else ""),
+                            ("parent_permlink", self.permlink()), ("author", self.account()),
+                            ("permlink", self.permlink()), ("title", "" if parent else self.text()),
+                            ("body", self.text()), ("json_metadata", self.text())])
+
+    def op_transfer(self):
+        return OrderedDict([("from", self.account()), ("to", self.account()),
+                            ("amount", self.asset(self.random.choice(["HIVE", "HBD"]))), ("memo", self.text())])
+
+    def op_transfer_to_vesting(self):
+        return OrderedDict([("from", self.account()), ("to", self.account()), ("amount", self.asset("HIVE"))])
+
+    def op_withdraw_vesting(self):
+        return OrderedDict([("account", self.account()), ("vesting_shares", self.asset("VESTS"))])
+
+    def op_limit_order_create(self):
+        sell, receive = self.random.sample(["HIVE", "HBD"], 2)
+        return OrderedDict([("owner", self.account()), ("orderid", self.uint32()),
+                            ("amount_to_sell", self.asset(sell)), ("min_to_receive", self.asset(receive)),
+                            ("fill_or_kill", self.flag()), ("expiration", self.timestamp())])
+
+    def op_limit_order_cancel(self):
+        return OrderedDict([("owner", self.account()), ("orderid", self.uint32())])
+
+    def op_feed_publish(self):
+        rate = OrderedDict([("base", self.asset("HBD")), ("quote", self.asset("HIVE"))])
+        return OrderedDict([("publisher", self.account()), ("exchange_rate", rate)])
+
+    def op_convert(self):
+        return OrderedDict([("owner", self.account()), ("requestid", self.uint32()), ("amount", self.asset("HBD"))])
+
+    def op_account_create(self):
+        return OrderedDict([("amount", self.asset("HIVE")), ("creator", self.account()),
+                            ("new_account_name", self.account()), ("owner", self.authority()),
+                            ("active", self.authority()), ("posting", self.authority()),
+                            ("memo_key", self.public_key()), ("json_metadata", "{}")])
+
+    def op_account_update(self):
+        return OrderedDict([("account", self.account()), ("owner", self.authority()),
+                            ("active", self.authority()), ("posting", self.authority()),
+                            ("memo_key", self.public_key()), ("json_metadata", "{}")])
+
+    def op_witness_update(self):
+        props = OrderedDict([("account_creation_fee", self.asset("HIVE")),
+                             ("maximum_block_size", self.uint32()), ("sbd_interest_rate", self.uint16(10000))])
+        return OrderedDict([("owner", self.account()), ("url", self.text()),
+                            ("block_signing_key", self.public_key()), ("props", props), ("fee", self.asset("HIVE"))])
+
+    def op_account_witness_vote(self):
+        return OrderedDict([("account", self.account()), ("witness", self.account()), ("approve", self.flag())])
+
+    def op_account_witness_proxy(self):
+        return OrderedDict([("account", self.account()), ("proxy", self.account())])
+
+    def op_delete_comment(self):
+        return OrderedDict([("author", self.account()), ("permlink", self.permlink())])
+
+    def op_custom_json(self):
+        return OrderedDict([("required_auths", self.accounts(self.count())),
+                            ("required_posting_auths", self.accounts(self.count())),
+                            ("id", self.permlink()), ("json", self.text())])
+
+    def op_comment_options(self):
+        # beneficiary weights add up to at most 100%, HIVE_MAX_COMMENT_BENEFICIARIES is 128
+        accounts = self.accounts(self.count(128))
+        weights = [self.random.randint(1, 10000 / len(accounts)) for account in accounts]
+        beneficiaries = [OrderedDict([("account", account), ("weight", weight)])
+                         for account, weight in zip(accounts, weights)]
+        return OrderedDict([("author", self.account()), ("permlink", self.permlink()),
+                            ("max_accepted_payout", self.asset("HBD")),
+                            ("percent_steem_dollars", self.uint16(10000)),
+                            ("allow_votes", self.flag()), ("allow_curation_rewards", self.flag()),
+                            ("extensions", [[0, {"beneficiaries": beneficiaries}]] if beneficiaries else [])])
+
+    def op_set_withdraw_vesting_route(self):
+        return OrderedDict([("from_account", self.account()), ("to_account", self.account()),
+                            ("percent", self.uint16(10000)), ("autovest", self.flag())])
+
+    def op_claim_account(self):
+        return OrderedDict([("creator", self.account()), ("fee", self.asset("HIVE")), ("extensions", [])])
+
+    def op_create_claimed_account(self):
+        return OrderedDict([("creator", self.account()), ("new_account_name", self.account()),
+                            ("owner", self.authority()), ("active", self.authority()),
+                            ("posting", self.authority()), ("memo_key", self.public_key()),
+                            ("json_metadata", "{}"), ("extensions", [])])
+
+    def op_request_account_recovery(self):
+        return OrderedDict([("recovery_account", self.account()), ("account_to_recover", self.account()),
+                            ("new_owner_authority", self.authority()), ("extensions", [])])
+
+    def op_recover_account(self):
+        return OrderedDict([("account_to_recover", self.account()), ("new_owner_authority", self.authority()),
+                            ("recent_owner_authority", self.authority()), ("extensions", [])])
+
+    def op_change_recovery_account(self):
+        return OrderedDict([("account_to_recover", self.account()),
+                            ("new_recovery_account", self.account()), ("extensions", [])])
+
+    def op_transfer_to_savings(self):
+        return self.op_transfer()
+
+    def op_transfer_from_savings(self):
+        return OrderedDict([("from", self.account()), ("request_id", self.uint32()), ("to", self.account()),
+                            ("amount", self.asset(self.random.choice(["HIVE", "HBD"]))), ("memo", self.text())])
+
+    def op_cancel_transfer_from_savings(self):
+        return OrderedDict([("from", self.account()), ("request_id", self.uint32())])
+
+    def op_decline_voting_rights(self):
+        return OrderedDict([("account", self.account()), ("decline", self.flag())])
+
+    def op_reset_account(self):
+        return OrderedDict([("reset_account", self.account()), ("account_to_reset_account", self.account()),
+                            ("new_owner_authority", self.authority())])
+
+    def op_set_reset_account(self):
+        return OrderedDict([("account", self.account()), ("current_reset_account", self.account()),
+                            ("reset_account", self.account())])
+
+    def op_claim_reward_balance(self):
+        return OrderedDict([("account", self.account()), ("reward_steem", self.asset("HIVE")),
+                            ("reward_sbd", self.asset("HBD")), ("reward_vests", self.asset("VESTS"))])
+
+    def op_delegate_vesting_shares(self):
+        return OrderedDict([("delegator", self.account()), ("delegatee", self.account()),
+                            ("vesting_shares", self.asset("VESTS"))])
+
+    def op_create_proposal(self):
+        start, end = sorted([self.timestamp(), self.timestamp()])
+        return OrderedDict([("creator", self.account()), ("receiver", self.account()),
+                            ("start_date", start), ("end_date", end), ("daily_pay", self.asset("HBD")),
+                            ("subject", self.text()), ("permlink", self.permlink()), ("extensions", [])])
+
+    def proposal_ids(self):
+        return sorted(set(self.random.randint(0, 100000) for i in range(self.count())))
+
+    def op_update_proposal_votes(self):
+        return OrderedDict([("voter", self.account()), ("proposal_ids", self.proposal_ids()),
+                            ("approve", self.flag()), ("extensions", [])])
+
+    def op_remove_proposal(self):
+        return OrderedDict([("proposal_owner", self.account()), ("proposal_ids", self.proposal_ids()),
+                            ("extensions", [])])
+
+    def operation(self, name, profile="typical"):
+        """ Random operation of the given type, shrunk until its encoding
+        fits the operation buffer of the device
+        """
+        encode = getattr(Transaction, 'parse_' + name)
+        self.profile = profile
+        self.maxStringLength = self.argDataSize - 1
+        self.maxListLength = 127
+        while True:
+            data = getattr(self, 'op_' + name)()
+            if len(encode(data)) < self.opBufferSize:
+                return [name, data]
+            self.maxStringLength = max(self.maxStringLength * 3 / 4, 8)
+            self.maxListLength = max(self.maxListLength * 3 / 4, 1)
+
+    def transaction(self, operations):
+        tx = OrderedDict()
+        tx["ref_block_num"] = self.uint16()
+        tx["ref_block_prefix"] = self.uint32()
+        tx["expiration"] = self.timestamp()
+        tx["operations"] = operations
+        tx["extensions"] = []
+        tx["signatures"] = []
+        return tx
+
+    def corpus(self, count, maxOperations=8):
+        """ Yields (name, transaction) pairs. Every operation comes first alone
+        in each profile, the rest are mixes of up to maxOperations operations.
+        """
+        index = 0
+        for profile in self.PROFILES:
+            for name in self.operations():
+                if index == count:
+                    return
+                yield "%05d-%s-%s" % (index, name, profile), self.transaction([self.operation(name, profile)])
+                index += 1
+        while index < count:
+            length = self.random.randint(2, maxOperations)
+            operations = [self.operation(self.random.choice(self.operations()), self.random.choice(self.PROFILES))
+                          for i in range(length)]
+            yield "%05d-mix%d" % (index, length), self.transaction(operations)
+            index += 1
@@ -0,0 +1,129 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Parses transactions with the host build of the device parser (make binding
+# in host/) and prints what the device would show for each one, or why it
+# would refuse it. No device is needed, so large batches can be checked
+# before they are sent for signing:
+#
+#   python hiveParser.py txs/*.json
+#   python hiveParser.py --encoded host/corpus/*.bin
+#
+# The memory profile is the one the library was built with (TARGET=nanox).
+import argparse
+import ctypes
+import json
+import os
+from hiveBase import DryRun, Fault, Transaction
+
+LIBRARY = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'host', 'build', 'libhiveparser.so')
+
+
+class ParserFault(Exception):
+    """ Transaction the device would refuse, sw and data as CommException
+    carries them
+    """
+    def __init__(self, sw, data):
+        Exception.__init__(self, Fault.describe(sw, data))
+        self.sw = sw
+        self.data = data
+
+
+class HostParser:
+    """ The device parser loaded from the host library, with the answers of
+    INS_DRY_RUN
+    """
+    FAULT_DATA_SIZE = 8
+
+    def __init__(self, library=LIBRARY, dataAllowed=True):
+        self.lib = ctypes.CDLL(library)
+        self.lib.hostDryRun.restype = ctypes.c_uint16
+        self.lib.hostDryRun.argtypes = [ctypes.c_char_p, ctypes.c_uint32, ctypes.c_uint8,
+                                        ctypes.c_char_p, ctypes.c_uint32,
+                                        ctypes.POINTER(ctypes.c_uint32), ctypes.c_char_p]
+        self.dataAllowed = dataAllowed
+        self.outSize = 4096
+
+    def run_encoded(self, encoded):
+        """ Returns the operations, each one (name, [(label, value)...]),
+        and the digest, or raises ParserFault.
+        """
+        encoded = str(encoded)
+        while True:
+            out = ctypes.create_string_buffer(self.outSize)
+            outLength = ctypes.c_uint32(0)
+            faultData = ctypes.create_string_buffer(HostParser.FAULT_DATA_SIZE)
+            sw = self.lib.hostDryRun(encoded, len(encoded), 1 if self.dataAllowed else 0,
+                                     out, self.outSize, ctypes.byref(outLength), faultData)
+            if sw != 0x9000:
+                raise ParserFault(sw, bytearray(faultData.raw))
+            if outLength.value <= self.outSize:
+                return DryRun.operations(DryRun.entries(out.raw[:outLength.value]))
+            # the entries did not fit, parse again with room for all of them
+            self.outSize = outLength.value
+
+    def run(self, tx):
+        return self.run_encoded(tx.encode(verbose=False))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--library', default=LIBRARY, help="Host build of the parser")
+    parser.add_argument('--no-data', action='store_true',
+                        help="Parse as with contract data not allowed on the device")
+    parser.add_argument('--network', choices=sorted(Transaction.NETWORKS),
+                        help="Send the network selector instead of the chain id")
+    parser.add_argument('--encoded', action='store_true',
+                        help="Files hold encoded transactions, as host/corpus/*.bin")
+    parser.add_argument('--quiet', action='store_true', help="Print refused transactions only")
+    parser.add_argument('files', nargs='+', help="Transactions in JSON format")
+    args = parser.parse_args()
+
+    hostParser = HostParser(args.library, not args.no_data)
+    refused = 0
+    for filename in args.files:
+        expected = None
+        if args.encoded:
+            with open(filename, 'rb') as f:
+                encoded = f.read()
+        else:
+            with open(filename) as f:
+                tx = Transaction.parse(json.load(f), verbose=False, network=args.network)
+            encoded = tx.encode(verbose=False)
+            expected = tx.digest()
+        try:
+            operations, digest = hostParser.run_encoded(encoded)
+        except ParserFault as e:
+            print "%s: refused, %s" % (filename, e)
+            refused += 1
+            continue
+        if expected is not None and digest != expected:
+            print "%s: digest %s, expected %s" % (filename, digest, expected)
+            refused += 1
+            continue
+        if args.quiet:
+            continue
+        print "%s: digest %s" % (filename, digest)
+        for index, (name, arguments) in enumerate(operations):
+            print "  operation %d: %s" % (index + 1, name)
+            for label, value in arguments:
+                print "    %s: %s" % (label, value)
+
+    print "%d transactions, %d refused" % (len(args.files), refused)
+    exit(1 if refused else 0)
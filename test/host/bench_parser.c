@@ -0,0 +1,158 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+/**
+ * Parser throughput benchmark.
+ *
+ *    bench_parser [-n iterations] [-c min-max] FILE...
+ *
+ * Every corpus file holds one encoded transaction, as produced by
+ * `make corpus`. Reports:
+ *   - ns per transaction byte and cx_hash calls per transaction for every
+ *     chunk size, without rendering
+ *   - ns per operation (all of its screens) and ns per screen render,
+ *     by operation type
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "host_driver.h"
+#include "host_corpus.h"
+
+#define MAX_OP_TYPE 64
+
+typedef struct opStats_t {
+    char name[HIVE_OP_NAME_SIZE];
+    uint64_t ops;
+    uint64_t renders;
+    uint64_t ns;
+} opStats_t;
+
+static opStats_t opStats[MAX_OP_TYPE];
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void timeRenders(txProcessingContext_t *context, void *user) {
+    uint8_t opType = context->content->opType;
+    uint8_t i;
+    UNUSED(user);
+
+    if (opType >= MAX_OP_TYPE) {
+        return;
+    }
+    opStats_t *stats = &opStats[opType];
+    os_memmove(stats->name, context->content->opName, sizeof(stats->name));
+    stats->ops++;
+
+    for (i = 0; i < (uint8_t) context->content->argumentCount; i++) {
+        uint64_t start = nowNs();
+        printArgument(i, context);
+        stats->ns += nowNs() - start;
+        stats->renders++;
+    }
+}
+
+int main(int argc, char **argv) {
+    static hostTxSession_t session;
+    hostCorpus_t corpus;
+    hostTxResult_t result;
+    uint32_t iterations = 100;
+    uint32_t minChunk = 1;
+    uint32_t maxChunk = HOST_MAX_CHUNK;
+    uint32_t chunk;
+    uint32_t i, n;
+    int arg = 1;
+
+    while (arg < argc && argv[arg][0] == '-') {
+        if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            iterations = strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            if (sscanf(argv[++arg], "%u-%u", &minChunk, &maxChunk) == 1) {
+                maxChunk = minChunk;
+            }
+        } else {
+            fprintf(stderr, "usage: %s [-n iterations] [-c min-max] files...\n", argv[0]);
+            return 2;
+        }
+        arg++;
+    }
+    if (minChunk < 1 || maxChunk > HOST_MAX_CHUNK || minChunk > maxChunk) {
+        fprintf(stderr, "chunk sizes must be within 1-%d\n", HOST_MAX_CHUNK);
+        return 2;
+    }
+    if (hostCorpusLoad(&corpus, argc - arg, argv + arg) != 0 || corpus.count == 0) {
+        fprintf(stderr, "no corpus\n");
+        return 2;
+    }
+
+    session.dataAllowed = 1;
+
+    // every transaction must parse before it is timed
+    for (i = 0; i < corpus.count; i++) {
+        hostParseTx(&session, corpus.items[i].data, corpus.items[i].length,
+                    &maxChunk, 1, hostRenderAction, NULL, &result);
+        if (result.status != STREAM_FINISHED) {
+            fprintf(stderr, "%s: parser fault 0x%04x at byte %u\n",
+                    corpus.items[i].name, 0x6A80 | result.fault.code, result.fault.offset);
+            return 1;
+        }
+    }
+
+    printf("# %u transactions, %u bytes, %u iterations\n",
+           corpus.count, corpus.totalLength, iterations);
+    printf("# chunk  ns/byte  cx_hash/tx\n");
+    for (chunk = minChunk; chunk <= maxChunk; chunk++) {
+        uint32_t hashCalls = G_host_cx_hash_calls;
+        uint64_t start = nowNs();
+        for (n = 0; n < iterations; n++) {
+            for (i = 0; i < corpus.count; i++) {
+                hostParseTx(&session, corpus.items[i].data, corpus.items[i].length,
+                            &chunk, 1, NULL, NULL, &result);
+            }
+        }
+        uint64_t elapsed = nowNs() - start;
+        printf("%7u %8.2f %11.1f\n", chunk,
+               (double) elapsed / ((double) corpus.totalLength * iterations),
+               (double) (G_host_cx_hash_calls - hashCalls) / ((double) corpus.count * iterations));
+    }
+
+    for (n = 0; n < iterations; n++) {
+        for (i = 0; i < corpus.count; i++) {
+            hostParseTx(&session, corpus.items[i].data, corpus.items[i].length,
+                        &maxChunk, 1, timeRenders, NULL, &result);
+        }
+    }
+
+    printf("# op type                         ns/op  ns/screen  screens/op\n");
+    for (i = 0; i < MAX_OP_TYPE; i++) {
+        if (opStats[i].ops == 0) {
+            continue;
+        }
+        printf("%2u %-28s %8.0f %10.0f %11.1f\n", i, opStats[i].name,
+               (double) opStats[i].ns / opStats[i].ops,
+               (double) opStats[i].ns / opStats[i].renders,
+               (double) opStats[i].renders / opStats[i].ops);
+    }
+
+    hostCorpusFree(&corpus);
+    return 0;
+}
@@ -0,0 +1,575 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+/**
+ * Chunk-boundary equivalence check.
+ *
+ *   check_split FILE...
+ *
+ * Every transaction is parsed once in a single pass (255 byte chunks) to get
+ * the reference transcript: final SHA-256, transaction id, operation
+ * sequence and every rendered label and value. The transaction id is checked
+ * against the hash of the field contents after the chain id. It is then replayed
+ *   - with an APDU boundary at every byte offset
+ *   - with every fixed chunk size from 1 to 255
+ *   - with two staging slots, every fixed chunk size again with reviews
+ *     lasting one and two more chunks while the next operation streams in
+ *   - resumed at every operation, the rest of the chunk sent again from
+ *     the offset the parser reports, at every fixed chunk size
+ *   - rebuilt from a template, the header fields and part of every
+ *     operation sent as values, one parseTx call per template piece
+ * and each transcript must match the reference byte for byte.
+ *
+ * With the chain id of every known network, the transaction sent with the
+ * network selector instead must give the transcript of the full chain id,
+ * at every chunk size. An unknown selector must be refused.
+ *
+ * It also checks the supported opType bitmap the capability block reports:
+ * an operation is accepted by the parser exactly when its bit is set.
+ * A witness_update cut short in its props must be refused.
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_driver.h"
+#include "host_corpus.h"
+#include "hive_template.h"
+
+#define TRANSCRIPT_SIZE 65536
+#define MAX_CHUNKS 1024
+
+typedef struct transcript_t {
+    char text[TRANSCRIPT_SIZE];
+    uint32_t length;
+} transcript_t;
+
+static transcript_t reference;
+static transcript_t current;
+static uint32_t chunks[MAX_CHUNKS];
+static hostCorpusItem_t *currentItem;
+
+#define REVIEW_MISMATCH "reviewed operation is not in the transaction"
+
+static void transcriptAppend(transcript_t *transcript, const char *text) {
+    uint32_t length = strlen(text);
+    if (length + 1 > sizeof(transcript->text) - transcript->length) {
+        fprintf(stderr, "transcript overflow\n");
+        exit(1);
+    }
+    memcpy(transcript->text + transcript->length, text, length);
+    transcript->length += length;
+    transcript->text[transcript->length++] = '\n';
+    transcript->text[transcript->length] = 0;
+}
+
+static void recordAction(txProcessingContext_t *context, void *user) {
+    transcript_t *transcript = (transcript_t *) user;
+    char line[16];
+    uint8_t i;
+
+    snprintf(line, sizeof(line), "op %u", context->content->opType);
+    transcriptAppend(transcript, line);
+    // the review slot must hold the operation as sent, whatever was staged since
+    if (memmem(currentItem->data, currentItem->length,
+               context->reviewBuffer, context->reviewBufferLength) == NULL ||
+        context->reviewBuffer[0] != context->content->opType) {
+        transcriptAppend(transcript, REVIEW_MISMATCH);
+    }
+    transcriptAppend(transcript, context->content->opName);
+    for (i = 0; i < (uint8_t) context->content->argumentCount; i++) {
+        printArgument(i, context);
+        transcriptAppend(transcript, context->content->arg.label);
+        transcriptAppend(transcript, context->content->arg.data);
+    }
+}
+
+static void run(hostTxSession_t *session, hostCorpusItem_t *item, uint32_t chunkCount,
+                transcript_t *transcript) {
+    hostTxResult_t result;
+    char line[80];
+    uint32_t i;
+
+    transcript->length = 0;
+    transcript->text[0] = 0;
+    currentItem = item;
+    hostParseTx(session, item->data, item->length, chunks, chunkCount,
+                recordAction, transcript, &result);
+
+    snprintf(line, sizeof(line), "status %d exception 0x%04x", result.status, result.exception);
+    transcriptAppend(transcript, line);
+    snprintf(line, sizeof(line), "fault %u offset %u state %u op %u argument %u",
+             result.fault.code, result.fault.offset, result.fault.state,
+             result.fault.opIndex, result.fault.argument);
+    transcriptAppend(transcript, line);
+    snprintf(line, sizeof(line), "network %s", networkName(&session->context));
+    transcriptAppend(transcript, line);
+    for (i = 0; i < sizeof(result.digest); i++) {
+        snprintf(line + i * 2, sizeof(line) - i * 2, "%02x", result.digest[i]);
+    }
+    transcriptAppend(transcript, line);
+    strcpy(line, "txid ");
+    for (i = 0; i < HIVE_TX_ID_SIZE; i++) {
+        snprintf(line + 5 + i * 2, sizeof(line) - 5 - i * 2, "%02x", result.txId[i]);
+    }
+    transcriptAppend(transcript, line);
+}
+
+/**
+ * Transaction id the way the host computes it: the contents of every DER
+ * field after the chain id, hashed.
+*/
+static uint32_t checkTxId(hostCorpusItem_t *item) {
+    cx_sha256_t sha256;
+    uint8_t hash[32];
+    char line[80];
+    uint32_t offset = 0;
+    uint32_t field = 0;
+    uint32_t i;
+
+    cx_sha256_init(&sha256);
+    while (offset + 2 <= item->length) {
+        uint32_t length = item->data[offset + 1];
+        uint32_t header = 2;
+        if (length == 0x81) {
+            length = item->data[offset + 2];
+            header = 3;
+        } else if (length == 0x82) {
+            length = (item->data[offset + 2] << 8) | item->data[offset + 3];
+            header = 4;
+        }
+        if (field++ > 0) {
+            cx_hash(&sha256.header, 0, item->data + offset + header, length, NULL, 0);
+        }
+        offset += header + length;
+    }
+    cx_hash(&sha256.header, CX_LAST, NULL, 0, hash, sizeof(hash));
+
+    strcpy(line, "txid ");
+    for (i = 0; i < HIVE_TX_ID_SIZE; i++) {
+        snprintf(line + 5 + i * 2, sizeof(line) - 5 - i * 2, "%02x", hash[i]);
+    }
+    if (strstr(reference.text, line) == NULL) {
+        fprintf(stderr, "%s: transaction id is not %s\n%s", item->name, line + 5, reference.text);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * APDU sized chunks with a boundary at the given offset.
+*/
+static uint32_t splitAt(uint32_t offset) {
+    uint32_t count = 0;
+    while (offset > HOST_MAX_CHUNK) {
+        chunks[count++] = HOST_MAX_CHUNK;
+        offset -= HOST_MAX_CHUNK;
+    }
+    chunks[count++] = offset;
+    chunks[count++] = HOST_MAX_CHUNK;
+    return count;
+}
+
+static int compare(const hostCorpusItem_t *item, const char *what, uint32_t value) {
+    uint32_t i;
+    if (current.length == reference.length && memcmp(current.text, reference.text, reference.length) == 0) {
+        return 0;
+    }
+    for (i = 0; i < reference.length && current.text[i] == reference.text[i]; i++);
+    fprintf(stderr, "%s: %s %u differs at transcript byte %u\n--- expected\n%s--- got\n%s",
+            item->name, what, value, i, reference.text, current.text);
+    return 1;
+}
+
+static uint32_t checkOpTypeBitmap(hostTxSession_t *session) {
+    // chain id, ref block num, ref block prefix, expiration, one operation
+    static const uint8_t header[] = {
+        0x04, 0x20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x04, 0x02, 0, 0,
+        0x04, 0x04, 0, 0, 0, 0,
+        0x04, 0x04, 0, 0, 0, 0,
+        0x04, 0x01, 0x01,
+    };
+    uint8_t tx[sizeof(header) + 3];
+    hostTxResult_t result;
+    uint32_t failures = 0;
+    uint32_t opType;
+
+    memcpy(tx, header, sizeof(header));
+    for (opType = 0; opType < 256; opType++) {
+        bool accepted;
+        bool advertised = opType < HIVE_OP_TYPE_BITMAP_SIZE * 8 &&
+                          (supportedOpTypes[opType / 8] & (1 << (opType % 8))) != 0;
+
+        // the operation is its type byte alone, enough to be recognized
+        tx[sizeof(header)] = 0x04;
+        tx[sizeof(header) + 1] = 0x01;
+        tx[sizeof(header) + 2] = opType;
+        chunks[0] = HOST_MAX_CHUNK;
+        hostParseTx(session, tx, sizeof(tx), chunks, 1, NULL, NULL, &result);
+        // the arguments are missing, only the operation type must be accepted
+        accepted = result.fault.code != FAULT_OP_TYPE;
+        if (advertised != accepted) {
+            fprintf(stderr, "opType %u: bitmap says %s, parser %s it\n", opType,
+                    advertised ? "supported" : "unsupported", accepted ? "accepts" : "rejects");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/**
+ * witness_update whose props end after the account creation fee. The
+ * arguments must be read within the operation, not from whatever the
+ * operation buffer held before.
+*/
+static uint32_t checkTruncatedWitnessUpdate(hostTxSession_t *session) {
+    // chain id, ref block num, ref block prefix, expiration, one operation
+    static const uint8_t header[] = {
+        0x04, 0x20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x04, 0x02, 0, 0,
+        0x04, 0x04, 0, 0, 0, 0,
+        0x04, 0x04, 0, 0, 0, 0,
+        0x04, 0x01, 0x01,
+    };
+    // owner "a", url "u", signing key, fee 1.000 HIVE, 2 of the 4 max block size bytes
+    static const uint8_t operation[] = {
+        0x0B, 0x01, 'a', 0x01, 'u',
+        0x03, 0x4C, 0x6A, 0x51, 0x8A, 0x9B, 0x9E, 0x9C, 0xB8, 0x09, 0x91,
+        0x76, 0x85, 0x4A, 0x32, 0x2C, 0x87, 0xDB, 0x6C, 0x7E, 0x82, 0xC4,
+        0x7B, 0xD5, 0xFE, 0x68, 0xC2, 0x73, 0xBA, 0x63, 0xA6, 0x47, 0x16,
+        0xE8, 0x03, 0, 0, 0, 0, 0, 0, 0x03, 'H', 'I', 'V', 'E', 0, 0, 0,
+        0x00, 0x00,
+    };
+    static const uint8_t extensions[] = {0x04, 0x01, 0x00};
+    uint8_t tx[sizeof(header) + 2 + sizeof(operation) + sizeof(extensions)];
+    hostTxResult_t result;
+    uint32_t length = 0;
+
+    memcpy(tx, header, sizeof(header));
+    length += sizeof(header);
+    tx[length++] = 0x04;
+    tx[length++] = sizeof(operation);
+    memcpy(tx + length, operation, sizeof(operation));
+    length += sizeof(operation);
+    memcpy(tx + length, extensions, sizeof(extensions));
+    length += sizeof(extensions);
+
+    chunks[0] = HOST_MAX_CHUNK;
+    hostParseTx(session, tx, length, chunks, 1, NULL, NULL, &result);
+    if (result.status != STREAM_FAULT || result.fault.code != FAULT_ARGUMENT || result.fault.argument != 3) {
+        fprintf(stderr, "truncated witness_update: status %u fault %u argument %u, expected props refused\n",
+                result.status, result.fault.code, result.fault.argument);
+        return 1;
+    }
+    return 0;
+}
+
+typedef struct templateBuilder_t {
+    uint8_t *data;
+    uint32_t length;
+    uint8_t *values;
+    uint32_t valuesLength;
+    uint32_t partCount;         // position of the current field's part count
+} templateBuilder_t;
+
+static void templateLiteral(templateBuilder_t *builder, const uint8_t *bytes, uint32_t length) {
+    while (length > 0) {
+        uint32_t size = length < 0xFF ? length : 0xFF;
+        builder->data[builder->partCount]++;
+        builder->data[builder->length++] = TEMPLATE_PART_LITERAL;
+        builder->data[builder->length++] = size;
+        memcpy(builder->data + builder->length, bytes, size);
+        builder->length += size;
+        bytes += size;
+        length -= size;
+    }
+}
+
+static void templateValue(templateBuilder_t *builder, const uint8_t *bytes, uint32_t length) {
+    builder->data[builder->partCount]++;
+    builder->data[builder->length++] = TEMPLATE_PART_VALUE;
+    builder->values[builder->valuesLength++] = length;
+    memcpy(builder->values + builder->valuesLength, bytes, length);
+    builder->valuesLength += length;
+}
+
+/**
+ * Template of the transaction as a bot would load it: the header fields
+ * and the middle of every operation are values, the rest is literal.
+ * False when the transaction is not made of DER octet strings.
+*/
+static bool templateBuild(templateBuilder_t *builder, const uint8_t *tx, uint32_t length) {
+    uint32_t offset = 0;
+    uint32_t field = 0;
+
+    builder->length = 1;
+    builder->valuesLength = 0;
+    builder->data[0] = 0;
+    while (offset < length) {
+        uint32_t contentLength = 0;
+        uint32_t lengthBytes;
+        const uint8_t *content;
+
+        if (length - offset < 2 || tx[offset] != 0x04 || field == 0xFF) {
+            return false;
+        }
+        lengthBytes = tx[offset + 1] < 0x80 ? 0 : tx[offset + 1] & 0x7F;
+        if (lengthBytes == 0) {
+            contentLength = tx[offset + 1];
+        }
+        if (lengthBytes > 2 || length - offset < 2 + lengthBytes) {
+            return false;
+        }
+        for (uint32_t i = 0; i < lengthBytes; i++) {
+            contentLength = (contentLength << 8) | tx[offset + 2 + i];
+        }
+        offset += 2 + lengthBytes;
+        if (contentLength > length - offset) {
+            return false;
+        }
+        content = tx + offset;
+        offset += contentLength;
+
+        builder->data[0]++;
+        builder->partCount = builder->length;
+        builder->data[builder->length++] = 0;
+        if (field >= TLV_HEADER_REF_BLOCK_NUM - 1 && field <= TLV_HEADER_EXPITATION - 1) {
+            templateValue(builder, content, contentLength);
+        } else if (field >= TLV_OPERATION_DATA - 1 && offset < length) {
+            uint32_t head = contentLength / 3;
+            uint32_t middle = contentLength / 3 < 0xFF ? contentLength / 3 : 0xFF;
+            templateLiteral(builder, content, head);
+            templateValue(builder, content + head, middle);
+            templateLiteral(builder, content + head + middle, contentLength - head - middle);
+        } else {
+            templateLiteral(builder, content, contentLength);
+        }
+        field++;
+    }
+    return true;
+}
+
+static uint32_t checkTemplate(hostTxSession_t *session, hostCorpusItem_t *item) {
+    templateBuilder_t builder;
+    txTemplateCursor_t cursor;
+    uint8_t *rebuilt;
+    uint32_t rebuiltLength = 0;
+    uint32_t chunkCount = 0;
+    uint32_t failures = 0;
+    uint8_t *piece;
+    uint32_t pieceLength;
+    bool bound;
+
+    builder.data = malloc(2 * item->length + 16);
+    // one spare byte for the extra value check
+    builder.values = malloc(item->length + 1);
+    rebuilt = malloc(item->length);
+    if (builder.data == NULL || builder.values == NULL || rebuilt == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    if (!templateBuild(&builder, item->data, item->length)) {
+        fprintf(stderr, "%s: not a template candidate\n", item->name);
+        failures++;
+        goto done;
+    }
+    if (builder.valuesLength > 0 &&
+        (templateBind(&cursor, builder.data, builder.length, builder.values, builder.valuesLength - 1) ||
+         templateBind(&cursor, builder.data, builder.length, builder.values, builder.valuesLength + 1))) {
+        fprintf(stderr, "%s: template accepts values of the wrong length\n", item->name);
+        failures++;
+    }
+    if (HIVE_TEMPLATE_SLOTS == 0 && templateStore(0, true, builder.data, builder.length)) {
+        fprintf(stderr, "%s: template stored without slots\n", item->name);
+        failures++;
+    }
+    if (HIVE_TEMPLATE_SLOTS > 0 && builder.length <= HIVE_TEMPLATE_SIZE) {
+        // loaded in two APDUs, as the host would
+        templateStore(0, true, builder.data, builder.length / 2);
+        templateStore(0, false, builder.data + builder.length / 2, builder.length - builder.length / 2);
+        bound = templateStart(&cursor, 0, builder.values, builder.valuesLength);
+    } else {
+        bound = templateBind(&cursor, builder.data, builder.length, builder.values, builder.valuesLength);
+    }
+    if (!bound) {
+        fprintf(stderr, "%s: template refused its own values\n", item->name);
+        failures++;
+        goto done;
+    }
+    while (templateNext(&cursor, &piece, &pieceLength)) {
+        if (pieceLength > item->length - rebuiltLength || chunkCount == MAX_CHUNKS) {
+            break;
+        }
+        memcpy(rebuilt + rebuiltLength, piece, pieceLength);
+        rebuiltLength += pieceLength;
+        chunks[chunkCount++] = pieceLength;
+    }
+    if (rebuiltLength != item->length || memcmp(rebuilt, item->data, item->length) != 0 ||
+        templateNext(&cursor, &piece, &pieceLength)) {
+        fprintf(stderr, "%s: template does not rebuild the transaction\n", item->name);
+        failures++;
+        goto done;
+    }
+    run(session, item, chunkCount, &current);
+    failures += compare(item, "template pieces", chunkCount);
+
+done:
+    free(builder.data);
+    free(builder.values);
+    free(rebuilt);
+    return failures;
+}
+
+static uint32_t checkNetworkSelector(hostTxSession_t *session, hostCorpusItem_t *item, uint32_t *runs) {
+    hostCorpusItem_t full = *item;
+    hostCorpusItem_t selected = *item;
+    uint32_t failures = 0;
+    uint32_t i, size;
+
+    // chain id header and content, then the rest of the transaction
+    if (item->length < 2 + HIVE_CHAIN_ID_SIZE || item->data[0] != 0x04 || item->data[1] != HIVE_CHAIN_ID_SIZE) {
+        fprintf(stderr, "%s: no chain id\n", item->name);
+        return 1;
+    }
+    full.data = malloc(item->length);
+    selected.data = malloc(item->length);
+    if (full.data == NULL || selected.data == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    memcpy(full.data, item->data, item->length);
+    selected.length = item->length - HIVE_CHAIN_ID_SIZE + 1;
+    selected.data[0] = 0x04;
+    selected.data[1] = 0x01;
+    memcpy(selected.data + 3, item->data + 2 + HIVE_CHAIN_ID_SIZE, item->length - 2 - HIVE_CHAIN_ID_SIZE);
+
+    for (i = 0; i < HIVE_NETWORK_COUNT; i++) {
+        memcpy(full.data + 2, hiveNetworks[i].chainId, HIVE_CHAIN_ID_SIZE);
+        chunks[0] = HOST_MAX_CHUNK;
+        run(session, &full, 1, &reference);
+        if (strstr(reference.text, hiveNetworks[i].name) == NULL) {
+            fprintf(stderr, "%s: chain id of %s not recognized\n%s", item->name, hiveNetworks[i].name, reference.text);
+            failures++;
+        }
+        // fault offsets are where the bytes were sent, equal up to the chain id
+        selected.data[2] = hiveNetworks[i].selector;
+        for (size = 1; size <= HOST_MAX_CHUNK; size++) {
+            chunks[0] = size;
+            run(session, &selected, 1, &current);
+            if (strstr(reference.text, "fault 0 ") != NULL) {
+                failures += compare(&selected, "network selector, chunk size", size);
+            }
+            (*runs)++;
+        }
+    }
+
+    selected.data[2] = 0xFF;
+    chunks[0] = HOST_MAX_CHUNK;
+    run(session, &selected, 1, &current);
+    if (strstr(current.text, "fault 7 offset 0 ") == NULL) {
+        fprintf(stderr, "%s: unknown network selector accepted\n%s", item->name, current.text);
+        failures++;
+    }
+
+    free(full.data);
+    free(selected.data);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    static hostTxSession_t session;
+    txTemplateCursor_t cursor;
+    hostCorpus_t corpus;
+    uint32_t failures = 0;
+    uint32_t runs = 0;
+    uint32_t i, offset, size;
+
+    if (hostCorpusLoad(&corpus, argc - 1, argv + 1) != 0 || corpus.count == 0) {
+        fprintf(stderr, "usage: %s files...\n", argv[0]);
+        return 2;
+    }
+    session.dataAllowed = 1;
+    session.txId = true;
+    failures += checkOpTypeBitmap(&session);
+    failures += checkTruncatedWitnessUpdate(&session);
+    // a template outgrowing its slot is dropped
+    templateStore(0, true, (const uint8_t *) "\x01\x00", 2);
+    if (templateStore(0, false, (const uint8_t *) reference.text, HIVE_TEMPLATE_SIZE - 1) ||
+        templateStart(&cursor, 0, NULL, 0)) {
+        fprintf(stderr, "template larger than its slot was kept\n");
+        failures++;
+    }
+
+    for (i = 0; i < corpus.count; i++) {
+        hostCorpusItem_t *item = &corpus.items[i];
+
+        if (item->length / HOST_MAX_CHUNK + 2 > MAX_CHUNKS) {
+            fprintf(stderr, "%s: too large\n", item->name);
+            return 2;
+        }
+
+        chunks[0] = HOST_MAX_CHUNK;
+        run(&session, item, 1, &reference);
+        if (strstr(reference.text, "status 4 ") == NULL || strstr(reference.text, REVIEW_MISMATCH) != NULL) {
+            fprintf(stderr, "%s: reference run did not finish\n%s", item->name, reference.text);
+            failures++;
+            continue;
+        }
+        failures += checkTxId(item);
+
+        for (offset = 1; offset < item->length; offset++) {
+            run(&session, item, splitAt(offset), &current);
+            failures += compare(item, "split at", offset);
+            runs++;
+        }
+        for (size = 1; size <= HOST_MAX_CHUNK; size++) {
+            chunks[0] = size;
+            run(&session, item, 1, &current);
+            failures += compare(item, "chunk size", size);
+            runs++;
+        }
+#if HIVE_OP_STAGING_SLOTS > 1
+        for (session.reviewChunks = 1; session.reviewChunks <= 2; session.reviewChunks++) {
+            for (size = 1; size <= HOST_MAX_CHUNK; size++) {
+                chunks[0] = size;
+                run(&session, item, 1, &current);
+                failures += compare(item, "overlapped review, chunk size", size);
+                runs++;
+            }
+        }
+        session.reviewChunks = 0;
+#endif
+        session.resumeAtAction = true;
+        for (size = 1; size <= HOST_MAX_CHUNK; size++) {
+            chunks[0] = size;
+            run(&session, item, 1, &current);
+            failures += compare(item, "resumed at every operation, chunk size", size);
+            runs++;
+        }
+        session.resumeAtAction = false;
+        failures += checkTemplate(&session, item);
+        runs++;
+        failures += checkNetworkSelector(&session, item, &runs);
+    }
+
+    printf("%u transactions, %u replays, %u failures\n", corpus.count, runs, failures);
+    hostCorpusFree(&corpus);
+    return failures != 0;
+}
@@ -0,0 +1,95 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+/**
+ * Stack high-water check.
+ *
+ *   check_stack
+ *
+ * Runs two nested measured sections, the way an INS handler encloses the
+ * printArgument calls, on a stack of its own that stands in for the one the
+ * SDK linker script provides (_stack, _estack). The outer section must see
+ * at least the depth the inner one reached.
+*/
+
+#include <stdio.h>
+#include <ucontext.h>
+#include "hive_stack.h"
+
+#define HOST_STACK_SIZE 16384
+#define INNER_DEPTH 4096
+
+// _stack and _estack are set to its bounds at link time
+uint32_t hostStack[HOST_STACK_SIZE / 4] __attribute__((aligned(16)));
+
+static ucontext_t mainContext;
+static ucontext_t stackContext;
+static uint8_t profile[512];
+static uint32_t profileLength;
+
+static void __attribute__((noinline)) deepCall(void) {
+    volatile uint8_t buffer[INNER_DEPTH];
+    uint32_t i;
+    for (i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = 0x5A;
+    }
+}
+
+static void __attribute__((noinline)) innerSection(void) {
+    uint32_t mark = stackProfileMark();
+    deepCall();
+    stackProfileRecordOp(1, mark);
+}
+
+static void profiledRun(void) {
+    uint32_t mark;
+
+    stackProfileInit();
+    mark = stackProfileMark();
+    innerSection();
+    stackProfileRecordIns(0x04, mark);
+    profileLength = stackProfileSerialize(profile, sizeof(profile));
+}
+
+static uint32_t peakAt(uint32_t offset) {
+    return (profile[offset] << 8) | profile[offset + 1];
+}
+
+int main(void) {
+    uint32_t insPeak, opPeak;
+
+    getcontext(&stackContext);
+    stackContext.uc_stack.ss_sp = hostStack;
+    stackContext.uc_stack.ss_size = sizeof(hostStack);
+    stackContext.uc_link = &mainContext;
+    makecontext(&stackContext, profiledRun, 0);
+    swapcontext(&mainContext, &stackContext);
+
+    // [stack size][static RAM][1]([ins][peak])[1]([opType][peak])
+    if (profileLength != 12 || profile[4] != 1 || profile[8] != 1) {
+        fprintf(stderr, "unexpected profile layout, %u bytes\n", profileLength);
+        return 1;
+    }
+    insPeak = peakAt(6);
+    opPeak = peakAt(10);
+    printf("ins peak %u bytes, nested op peak %u bytes\n", insPeak, opPeak);
+    if (opPeak < INNER_DEPTH || insPeak < opPeak) {
+        fprintf(stderr, "the enclosing section lost the nested peak\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Encodes every JSON transaction of a directory into <name>.bin, the bytes
+# signTransaction.py streams after the BIP 32 path.
+import argparse
+import glob
+import json
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+from hiveBase import Transaction
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--txs', help="Directory with transactions in JSON format")
+parser.add_argument('--output', help="Directory for the encoded transactions")
+args = parser.parse_args()
+
+if args.txs is None:
+    args.txs = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'txs')
+if args.output is None:
+    args.output = 'corpus'
+
+if not os.path.isdir(args.output):
+    os.makedirs(args.output)
+
+for filename in sorted(glob.glob(os.path.join(args.txs, '*.json'))):
+    with open(filename) as f:
+        tx = Transaction.parse(json.load(f))
+    name = os.path.splitext(os.path.basename(filename))[0] + '.bin'
+    with open(os.path.join(args.output, name), 'wb') as f:
+        f.write(tx.encode())
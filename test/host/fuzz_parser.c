@@ -0,0 +1,286 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+/**
+ * Fuzz target for parseTx and printArgument.
+ *
+ * Input layout: [chunk seed, 4 bytes][encoded transaction]. The seed draws
+ * the APDU chunk boundaries, every action that becomes ready is rendered
+ * screen by screen. Besides sanitizer findings the target aborts when
+ *   - a single screen takes longer than HIVE_FUZZ_SCREEN_NS (default 20 ms)
+ *   - the whole input takes longer than HIVE_FUZZ_INPUT_NS (default 200 ms)
+ *   - a rendered label or value is not terminated inside its buffer
+ *   - read as a template and its values, a piece falls outside of them
+ * The defaults suit the sanitized build, the slowest screen seen is reported
+ * at the end of a standalone run.
+ *
+ * Built with clang as a libFuzzer target (make fuzz-libfuzzer CC=clang),
+ * otherwise with a standalone driver that replays files and mutates them:
+ *
+ *   fuzz_parser [-n runs] [-t seconds] [-s seed] [-raw] FILE...
+ *
+ * -raw marks the files as plain transactions (corpus/<name>.bin), a random
+ * chunk seed is put in front of them.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "host_driver.h"
+#include "host_corpus.h"
+#include "hive_template.h"
+
+#define FUZZ_SEED_SIZE 4
+#define FUZZ_MAX_TX 8192
+
+typedef struct fuzzBudget_t {
+    uint64_t screenNs;
+    uint64_t inputNs;
+    uint64_t worstScreenNs;
+    uint8_t worstOpType;
+} fuzzBudget_t;
+
+static fuzzBudget_t budget;
+static uint32_t chunkSizes[FUZZ_MAX_TX];
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t envBudget(const char *name, uint64_t fallback) {
+    const char *value = getenv(name);
+    return value != NULL ? strtoull(value, NULL, 10) : fallback;
+}
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void checkTerminated(const char *buffer, size_t size, const char *what) {
+    if (memchr(buffer, 0, size) == NULL) {
+        fprintf(stderr, "%s is not terminated\n", what);
+        abort();
+    }
+}
+
+static void renderWithBudget(txProcessingContext_t *context, void *user) {
+    uint8_t i;
+    UNUSED(user);
+
+    checkTerminated(context->content->opName, sizeof(context->content->opName), "operation name");
+    for (i = 0; i < (uint8_t) context->content->argumentCount; i++) {
+        uint64_t start = nowNs();
+        printArgument(i, context);
+        uint64_t elapsed = nowNs() - start;
+
+        checkTerminated(context->content->arg.label, sizeof(context->content->arg.label), "argument label");
+        checkTerminated(context->content->arg.data, sizeof(context->content->arg.data), "argument value");
+        if (elapsed > budget.worstScreenNs) {
+            budget.worstScreenNs = elapsed;
+            budget.worstOpType = context->content->opType;
+        }
+        if (elapsed > budget.screenNs) {
+            fprintf(stderr, "screen %u of %s took %llu ns\n", i, context->content->opName,
+                    (unsigned long long) elapsed);
+            abort();
+        }
+    }
+}
+
+/**
+ * Templates come from the host as well, split the input into one.
+*/
+static void fuzzTemplate(uint8_t *data, uint32_t size, uint8_t split) {
+    txTemplateCursor_t cursor;
+    uint32_t templateLength = size * split / 256;
+    uint8_t *piece;
+    uint32_t length;
+
+    if (!templateBind(&cursor, data, templateLength, data + templateLength, size - templateLength)) {
+        return;
+    }
+    while (templateNext(&cursor, &piece, &length)) {
+        bool inHeader = piece == cursor.header && length <= sizeof(cursor.header);
+        bool inInput = piece >= data && length <= size && piece - data <= size - length;
+        if (!inHeader && !inInput) {
+            fprintf(stderr, "template piece outside of the input\n");
+            abort();
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static hostTxSession_t session;
+    hostTxResult_t result;
+    uint32_t state;
+    uint32_t i;
+
+    if (budget.screenNs == 0) {
+        budget.screenNs = envBudget("HIVE_FUZZ_SCREEN_NS", 20000000);
+        budget.inputNs = envBudget("HIVE_FUZZ_INPUT_NS", 200000000);
+    }
+    if (size < FUZZ_SEED_SIZE || size - FUZZ_SEED_SIZE > FUZZ_MAX_TX) {
+        return 0;
+    }
+
+    state = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+    if (state == 0) {
+        state = 1;
+    }
+    for (i = 0; i < size - FUZZ_SEED_SIZE; i++) {
+        chunkSizes[i] = 1 + xorshift32(&state) % HOST_MAX_CHUNK;
+    }
+
+    session.dataAllowed = data[0] & 0x01;
+    // with two staging slots, reviews overlap the next chunks
+    session.reviewChunks = data[1] % 3;
+
+    uint64_t start = nowNs();
+    hostParseTx(&session, data + FUZZ_SEED_SIZE, size - FUZZ_SEED_SIZE,
+                chunkSizes, size > FUZZ_SEED_SIZE ? size - FUZZ_SEED_SIZE : 1,
+                renderWithBudget, NULL, &result);
+    fuzzTemplate((uint8_t *) data + FUZZ_SEED_SIZE, size - FUZZ_SEED_SIZE, data[2]);
+    uint64_t elapsed = nowNs() - start;
+    if (elapsed > budget.inputNs) {
+        fprintf(stderr, "input of %zu bytes took %llu ns\n", size, (unsigned long long) elapsed);
+        abort();
+    }
+
+    return 0;
+}
+
+#ifndef HOST_LIBFUZZER
+
+static uint8_t input[FUZZ_SEED_SIZE + FUZZ_MAX_TX];
+
+static size_t mutate(uint8_t *data, size_t size, uint32_t *state) {
+    uint32_t count = 1 + xorshift32(state) % 4;
+    while (count--) {
+        uint32_t pos = size > 0 ? xorshift32(state) % size : 0;
+        switch (xorshift32(state) % 5) {
+        case 0:
+            // bit flip
+            if (size > 0) {
+                data[pos] ^= 1 << (xorshift32(state) % 8);
+            }
+            break;
+        case 1:
+            // random byte, DER lengths and fc varints are the interesting ones
+            if (size > 0) {
+                data[pos] = xorshift32(state);
+            }
+            break;
+        case 2:
+            // insert
+            if (size < sizeof(input)) {
+                memmove(data + pos + 1, data + pos, size - pos);
+                data[pos] = xorshift32(state);
+                size++;
+            }
+            break;
+        case 3:
+            // delete
+            if (size > FUZZ_SEED_SIZE) {
+                memmove(data + pos, data + pos + 1, size - pos - 1);
+                size--;
+            }
+            break;
+        default:
+            // new chunk boundaries
+            if (size >= FUZZ_SEED_SIZE) {
+                uint32_t seed = xorshift32(state);
+                memcpy(data, &seed, FUZZ_SEED_SIZE);
+            }
+            break;
+        }
+    }
+    return size;
+}
+
+int main(int argc, char **argv) {
+    hostCorpus_t corpus;
+    uint32_t runs = 0;
+    uint32_t seconds = 0;
+    uint32_t state = (uint32_t) time(NULL);
+    int raw = 0;
+    int arg = 1;
+    uint32_t n;
+
+    while (arg < argc && argv[arg][0] == '-') {
+        if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            runs = strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+            seconds = strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "-s") == 0 && arg + 1 < argc) {
+            state = strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "-raw") == 0) {
+            raw = 1;
+        } else {
+            fprintf(stderr, "usage: %s [-n runs] [-t seconds] [-s seed] [-raw] files...\n", argv[0]);
+            return 2;
+        }
+        arg++;
+    }
+    if (hostCorpusLoad(&corpus, argc - arg, argv + arg) != 0 || corpus.count == 0) {
+        fprintf(stderr, "no corpus\n");
+        return 2;
+    }
+    if (state == 0) {
+        state = 1;
+    }
+    printf("seed %u\n", state);
+
+    // corpus files first, then mutations until the run count or the deadline
+    uint64_t deadline = seconds != 0 ? nowNs() + (uint64_t) seconds * 1000000000ULL : 0;
+    for (n = 0; ; n++) {
+        if (n >= corpus.count && (deadline != 0 ? nowNs() > deadline : n >= corpus.count + runs)) {
+            break;
+        }
+
+        hostCorpusItem_t *item = &corpus.items[n < corpus.count ? n : xorshift32(&state) % corpus.count];
+        size_t size = 0;
+        if (raw) {
+            uint32_t seed = xorshift32(&state);
+            memcpy(input, &seed, FUZZ_SEED_SIZE);
+            size = FUZZ_SEED_SIZE;
+        }
+        if (item->length > sizeof(input) - size) {
+            continue;
+        }
+        memcpy(input + size, item->data, item->length);
+        size += item->length;
+
+        if (n >= corpus.count) {
+            size = mutate(input, size, &state);
+        }
+        LLVMFuzzerTestOneInput(input, size);
+    }
+
+    printf("%u inputs, slowest screen %llu ns (op type %u)\n", n,
+           (unsigned long long) budget.worstScreenNs, budget.worstOpType);
+    hostCorpusFree(&corpus);
+    return 0;
+}
+
+#endif // HOST_LIBFUZZER
@@ -0,0 +1,94 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <string.h>
+#include "host_binding.h"
+#include "host_driver.h"
+
+typedef struct hostEntries_t {
+    uint8_t *out;
+    uint32_t size;
+    uint32_t length;
+} hostEntries_t;
+
+/**
+ * Append an entry, texts longer than an entry span several of the same tag.
+*/
+static void appendEntry(hostEntries_t *entries, uint8_t tag, const uint8_t *text, uint32_t length) {
+    do {
+        uint32_t piece = length > 0xFF ? 0xFF : length;
+        if (entries->length + 2 + piece <= entries->size) {
+            entries->out[entries->length] = tag;
+            entries->out[entries->length + 1] = piece;
+            memcpy(entries->out + entries->length + 2, text, piece);
+        }
+        entries->length += 2 + piece;
+        text += piece;
+        length -= piece;
+    } while (length > 0);
+}
+
+static void appendText(hostEntries_t *entries, uint8_t tag, const char *text) {
+    appendEntry(entries, tag, (const uint8_t *) text, strlen(text));
+}
+
+static void recordAction(txProcessingContext_t *context, void *user) {
+    hostEntries_t *entries = user;
+    uint8_t i;
+
+    appendText(entries, HOST_ENTRY_OPERATION, context->content->opName);
+    appendText(entries, HOST_ENTRY_LABEL, "Network");
+    appendText(entries, HOST_ENTRY_VALUE, networkName(context));
+    for (i = 0; i < (uint8_t) context->content->argumentCount; i++) {
+        printArgument(i, context);
+        appendText(entries, HOST_ENTRY_LABEL, context->content->arg.label);
+        appendText(entries, HOST_ENTRY_VALUE, context->content->arg.data);
+    }
+}
+
+uint16_t hostDryRun(const uint8_t *tx, uint32_t length, uint8_t dataAllowed,
+                    uint8_t *out, uint32_t outSize, uint32_t *outLength,
+                    uint8_t *faultData) {
+    static hostTxSession_t session;
+    static const uint32_t chunks[] = {HOST_MAX_CHUNK};
+    hostEntries_t entries = {out, outSize, 0};
+    hostTxResult_t result;
+
+    memset(&session, 0, sizeof(session));
+    session.dataAllowed = dataAllowed;
+    hostParseTx(&session, tx, length, chunks, 1, recordAction, &entries, &result);
+    *outLength = entries.length;
+    memset(faultData, 0, HOST_FAULT_DATA_SIZE);
+    if (result.exception != 0) {
+        // mapped as the APDU dispatcher does
+        return (result.exception & 0xF000) == 0x6000 ? result.exception : 0x6800 | (result.exception & 0x7FF);
+    }
+    if (result.status != STREAM_FINISHED) {
+        // a transaction that ends early faults at its end
+        if (result.consumed == length && result.fault.code == FAULT_NONE) {
+            session.context.fault.offset = length;
+            session.context.fault.state = session.context.state;
+            session.context.fault.opIndex = session.context.currentOpIndex;
+            session.context.fault.argument = FAULT_NO_ARGUMENT;
+        }
+        faultSerialize(&session.context, faultData, HOST_FAULT_DATA_SIZE);
+        return 0x6A80 | session.context.fault.code;
+    }
+    appendEntry(&entries, HOST_ENTRY_DIGEST, result.digest, sizeof(result.digest));
+    *outLength = entries.length;
+    return 0x9000;
+}
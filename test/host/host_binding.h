@@ -0,0 +1,51 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HOST_BINDING_H__
+#define __HOST_BINDING_H__
+
+#include <stdint.h>
+
+/**
+ * Flat interface of the host parser for other languages, built as a shared
+ * library (make binding) and loaded by ../hiveParser.py.
+*/
+
+// entry tags, as INS_DRY_RUN writes them
+#define HOST_ENTRY_OPERATION 0x01
+#define HOST_ENTRY_LABEL 0x02
+#define HOST_ENTRY_VALUE 0x03
+#define HOST_ENTRY_DIGEST 0x04
+
+// fault data, as the device sends it with the fault status word
+#define HOST_FAULT_DATA_SIZE 8
+
+/**
+ * Parse a whole encoded transaction in APDU sized chunks, the way the device
+ * does, and write what it would show as entries: tag (1), length (1), text.
+ * Every operation is its name, then a label and a value for the network and
+ * for every argument; the digest comes last.
+ *
+ * Returns the status word the device would answer: 0x9000, or the fault
+ * status word with its data in faultData. *outLength is the length the
+ * entries need, nothing is written past outSize.
+*/
+uint16_t hostDryRun(const uint8_t *tx, uint32_t length, uint8_t dataAllowed,
+                    uint8_t *out, uint32_t outSize, uint32_t *outLength,
+                    uint8_t *faultData);
+
+#endif // __HOST_BINDING_H__
@@ -0,0 +1,76 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_corpus.h"
+
+static int readFile(const char *name, hostCorpusItem_t *item) {
+    FILE *f = fopen(name, "rb");
+    long size;
+
+    if (f == NULL) {
+        perror(name);
+        return -1;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) {
+        perror(name);
+        fclose(f);
+        return -1;
+    }
+    item->name = name;
+    item->length = (uint32_t) size;
+    item->data = malloc(size > 0 ? size : 1);
+    if (item->data == NULL || fread(item->data, 1, size, f) != (size_t) size) {
+        fprintf(stderr, "%s: read failed\n", name);
+        free(item->data);
+        item->data = NULL;
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+int hostCorpusLoad(hostCorpus_t *corpus, int fileCount, char **files) {
+    int i;
+
+    memset(corpus, 0, sizeof(hostCorpus_t));
+    corpus->items = calloc(fileCount > 0 ? fileCount : 1, sizeof(hostCorpusItem_t));
+    if (corpus->items == NULL) {
+        return -1;
+    }
+    for (i = 0; i < fileCount; i++) {
+        if (readFile(files[i], &corpus->items[corpus->count]) != 0) {
+            hostCorpusFree(corpus);
+            return -1;
+        }
+        corpus->totalLength += corpus->items[corpus->count].length;
+        corpus->count++;
+    }
+    return 0;
+}
+
+void hostCorpusFree(hostCorpus_t *corpus) {
+    uint32_t i;
+    for (i = 0; i < corpus->count; i++) {
+        free(corpus->items[i].data);
+    }
+    free(corpus->items);
+    memset(corpus, 0, sizeof(hostCorpus_t));
+}
@@ -0,0 +1,42 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HOST_CORPUS_H__
+#define __HOST_CORPUS_H__
+
+#include <stdint.h>
+
+/**
+ * Encoded transactions loaded from files, one transaction per file.
+*/
+
+typedef struct hostCorpusItem_t {
+    const char *name;
+    uint8_t *data;
+    uint32_t length;
+} hostCorpusItem_t;
+
+typedef struct hostCorpus_t {
+    hostCorpusItem_t *items;
+    uint32_t count;
+    uint32_t totalLength;
+} hostCorpus_t;
+
+int hostCorpusLoad(hostCorpus_t *corpus, int fileCount, char **files);
+void hostCorpusFree(hostCorpus_t *corpus);
+
+#endif // __HOST_CORPUS_H__
@@ -0,0 +1,145 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "host_driver.h"
+
+static uint32_t chunkSize(const uint32_t *chunkSizes, uint32_t chunkCount, uint32_t index) {
+    uint32_t size = chunkSizes[index < chunkCount ? index : chunkCount - 1];
+    if (size == 0) {
+        return 1;
+    }
+    return size > HOST_MAX_CHUNK ? HOST_MAX_CHUNK : size;
+}
+
+typedef struct hostReview_t {
+    bool active;
+    uint32_t chunks;
+} hostReview_t;
+
+static void endReview(hostTxSession_t *session, hostReview_t *review,
+                      hostActionCallback_t onAction, void *user) {
+    if (review->active && onAction != NULL) {
+        onAction(&session->context, user);
+    }
+    review->active = false;
+}
+
+static parserStatus_e feedChunk(hostTxSession_t *session, uint8_t *buffer, uint32_t length,
+                                hostReview_t *review,
+                                hostActionCallback_t onAction, void *user,
+                                hostTxResult_t *result) {
+    bool parseAhead = HIVE_OP_STAGING_SLOTS > 1 && session->reviewChunks > 0;
+    parserStatus_e status = parseTx(&session->context, buffer, length);
+    for (;;) {
+        switch (status) {
+        case STREAM_ACTION_READY:
+            // the review slot is free once the previous review is over
+            endReview(session, review, onAction, user);
+            presentAction(&session->context);
+            result->actions++;
+            review->active = true;
+            review->chunks = 0;
+            if (!parseAhead) {
+                endReview(session, review, onAction, user);
+            }
+            if (session->resumeAtAction) {
+                // the next chunk is read again from there
+                result->consumed = dropTxChunk(&session->context);
+            }
+            status = parseTx(&session->context, NULL, 0);
+            break;
+        case STREAM_CONFIRM_PROCESSING:
+            status = parseTx(&session->context, NULL, 0);
+            break;
+        case STREAM_PROCESSING:
+            if (review->active && review->chunks++ >= session->reviewChunks) {
+                endReview(session, review, onAction, user);
+            }
+            return status;
+        case STREAM_FINISHED:
+            endReview(session, review, onAction, user);
+            return status;
+        default:
+            return status;
+        }
+    }
+}
+
+void hostParseTx(hostTxSession_t *session,
+                 const uint8_t *tx, uint32_t length,
+                 const uint32_t *chunkSizes, uint32_t chunkCount,
+                 hostActionCallback_t onAction, void *user,
+                 hostTxResult_t *result) {
+    // chunks are copied, as the APDU buffer is, so over-reads stay visible
+    uint8_t buffer[HOST_MAX_CHUNK];
+    hostReview_t review;
+
+    os_memset(result, 0, sizeof(hostTxResult_t));
+    os_memset(&review, 0, sizeof(review));
+    result->status = STREAM_FAULT;
+
+    BEGIN_TRY {
+        TRY {
+            initTxContext(&session->context, &session->sha256,
+                          &session->content, session->dataAllowed);
+            if (session->txId) {
+                hashTxIdStart(&session->context, &session->txIdSha256);
+            }
+
+            while (result->consumed < length) {
+                uint32_t size = chunkSize(chunkSizes, chunkCount, result->chunks);
+                if (size > length - result->consumed) {
+                    size = length - result->consumed;
+                }
+                os_memmove(buffer, tx + result->consumed, size);
+                result->consumed += size;
+                result->chunks++;
+
+                parserStatus_e status = feedChunk(session, buffer, size, &review, onAction, user, result);
+                if (status == STREAM_FINISHED) {
+                    hashTxFinalize(&session->context, result->digest, sizeof(result->digest));
+                    if (session->txId) {
+                        hashTxIdFinalize(&session->context, result->txId, sizeof(result->txId));
+                    }
+                    result->status = STREAM_FINISHED;
+                    break;
+                }
+                if (status != STREAM_PROCESSING) {
+                    break;
+                }
+            }
+        }
+        CATCH_OTHER(e) {
+            result->exception = e;
+            result->status = STREAM_FAULT;
+        }
+        FINALLY {
+        }
+    }
+    END_TRY;
+    if (result->status == STREAM_FAULT) {
+        result->fault = session->context.fault;
+    }
+}
+
+void hostRenderAction(txProcessingContext_t *context, void *user) {
+    uint8_t i;
+    UNUSED(user);
+    for (i = 0; i < (uint8_t) context->content->argumentCount; i++) {
+        printArgument(i, context);
+    }
+}
@@ -0,0 +1,81 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HOST_DRIVER_H__
+#define __HOST_DRIVER_H__
+
+#include <stdint.h>
+#include "hive_stream.h"
+
+#define HOST_MAX_CHUNK 255
+
+/**
+ * Drives the streaming parser the way handleSign and the review screens do:
+ * the transaction is cut in APDU sized chunks, every STREAM_ACTION_READY is
+ * presented and handed to the action callback (the review) and parsing
+ * resumes with an empty buffer until the chunk is consumed.
+ *
+ * With HIVE_OP_STAGING_SLOTS > 1 and reviewChunks > 0 a review lasts that
+ * many more chunks, parsing goes on meanwhile and the callback runs when the
+ * review ends: after its chunks, or earlier when the next operation is ready
+ * or the transaction is finished.
+ *
+ * With resumeAtAction, the rest of the chunk is dropped at every operation
+ * as a RESUME during its review does, and the transaction goes on from the
+ * offset the parser reports.
+*/
+
+typedef void (*hostActionCallback_t)(txProcessingContext_t *context, void *user);
+
+typedef struct hostTxSession_t {
+    cx_sha256_t sha256;
+    cx_sha256_t txIdSha256;
+    bool txId;                  // hash the transaction id as well
+    txProcessingContext_t context;
+    txProcessingContent_t content;
+    uint8_t dataAllowed;
+    uint32_t reviewChunks;
+    bool resumeAtAction;
+} hostTxSession_t;
+
+typedef struct hostTxResult_t {
+    parserStatus_e status;      // STREAM_FINISHED or STREAM_FAULT
+    uint16_t exception;         // exception thrown by the parser or a renderer
+    txFault_t fault;            // where the parser refused the transaction
+    uint32_t consumed;          // transaction bytes handed to the parser
+    uint32_t chunks;
+    uint32_t actions;
+    uint8_t digest[32];
+    uint8_t txId[32];           // transaction id hash, when session->txId
+} hostTxResult_t;
+
+/**
+ * Chunk i has chunkSizes[i] bytes, the last size repeats once the list
+ * is exhausted. Sizes are clamped to 1..HOST_MAX_CHUNK.
+*/
+void hostParseTx(hostTxSession_t *session,
+                 const uint8_t *tx, uint32_t length,
+                 const uint32_t *chunkSizes, uint32_t chunkCount,
+                 hostActionCallback_t onAction, void *user,
+                 hostTxResult_t *result);
+
+/**
+ * Render every argument of the action under review.
+*/
+void hostRenderAction(txProcessingContext_t *context, void *user);
+
+#endif // __HOST_DRIVER_H__
@@ -0,0 +1,76 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HOST_CX_H__
+#define __HOST_CX_H__
+
+/**
+ * Host stand-in for the hashing part of the BOLOS SDK cx.h:
+ * SHA-256, RIPEMD-160 and HMAC-SHA256 with the SDK calling conventions.
+*/
+
+#include <stdint.h>
+
+#define CX_LAST (1 << 0)
+
+#define CX_SHA256_SIZE 32
+#define CX_RIPEMD160_SIZE 20
+
+typedef enum cx_md_e {
+    CX_NONE = 0,
+    CX_RIPEMD160 = 1,
+    CX_SHA256 = 3
+} cx_md_t;
+
+typedef struct cx_hash_t {
+    cx_md_t algo;
+    uint32_t counter;
+} cx_hash_t;
+
+typedef struct cx_sha256_t {
+    cx_hash_t header;
+    uint32_t blen;
+    uint8_t block[64];
+    uint32_t acc[8];
+} cx_sha256_t;
+
+typedef struct cx_ripemd160_t {
+    cx_hash_t header;
+    uint32_t blen;
+    uint8_t block[64];
+    uint32_t acc[5];
+} cx_ripemd160_t;
+
+typedef struct cx_hmac_sha256_t {
+    cx_sha256_t hash;
+    uint8_t key[64];
+} cx_hmac_sha256_t;
+
+typedef cx_hmac_sha256_t cx_hmac_t;
+
+int cx_sha256_init(cx_sha256_t *hash);
+int cx_ripemd160_init(cx_ripemd160_t *hash);
+int cx_hash(cx_hash_t *hash, int mode, const unsigned char *in, unsigned int len,
+            unsigned char *out, unsigned int out_len);
+int cx_hmac_sha256_init(cx_hmac_sha256_t *hmac, const unsigned char *key, unsigned int key_len);
+int cx_hmac(cx_hmac_t *hmac, int mode, const unsigned char *in, unsigned int len,
+            unsigned char *mac, unsigned int mac_len);
+
+// Number of cx_hash calls since start-up, host builds only
+extern uint32_t G_host_cx_hash_calls;
+
+#endif // __HOST_CX_H__
@@ -0,0 +1,119 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef __HOST_OS_H__
+#define __HOST_OS_H__
+
+/**
+ * Host stand-in for the subset of the BOLOS SDK os.h used by the parser
+ * sources. Exceptions follow the SDK semantics: setjmp based frames,
+ * CATCH/CATCH_OTHER pop the frame and END_TRY rethrows anything unhandled.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+#include "cx.h"
+
+typedef unsigned short exception_t;
+
+#define EXCEPTION 1
+#define INVALID_PARAMETER 2
+#define EXCEPTION_OVERFLOW 3
+#define EXCEPTION_SECURITY 4
+#define INVALID_CRC 5
+#define INVALID_CHECKSUM 6
+#define INVALID_COUNTER 7
+#define NOT_SUPPORTED 8
+#define INVALID_STATE 9
+#define TIMEOUT 10
+#define EXCEPTION_PIC 11
+#define EXCEPTION_APPEXIT 12
+#define EXCEPTION_IO_OVERFLOW 13
+#define EXCEPTION_IO_HEADER 14
+#define EXCEPTION_IO_STATE 15
+#define EXCEPTION_IO_RESET 16
+#define EXCEPTION_CXPORT 17
+#define EXCEPTION_SYSTEM 18
+
+typedef struct try_context_t {
+    jmp_buf jmp_buf;
+    struct try_context_t *previous;
+    exception_t ex;
+} try_context_t;
+
+extern try_context_t *G_host_try_context;
+
+void os_longjmp(exception_t exception) __attribute__((noreturn));
+
+#define THROW(x) os_longjmp(x)
+
+#define BEGIN_TRY                                                              \
+    {                                                                          \
+        try_context_t __try;                                                   \
+        __try.previous = G_host_try_context;
+
+#define TRY                                                                    \
+    __try.ex = setjmp(__try.jmp_buf);                                          \
+    if (__try.ex == 0) {                                                       \
+        G_host_try_context = &__try;
+
+#define CATCH(x)                                                               \
+    goto __FINALLY;                                                            \
+    }                                                                          \
+    else if (__try.ex == (x)) {                                                \
+        __try.ex = 0;                                                          \
+        G_host_try_context = __try.previous;
+
+#define CATCH_OTHER(e)                                                         \
+    goto __FINALLY;                                                            \
+    }                                                                          \
+    else {                                                                     \
+        exception_t e = __try.ex;                                              \
+        (void) e;                                                              \
+        __try.ex = 0;                                                          \
+        G_host_try_context = __try.previous;
+
+#define FINALLY                                                                \
+    goto __FINALLY;                                                            \
+    }                                                                          \
+    __FINALLY:                                                                 \
+    if (G_host_try_context == &__try) {                                        \
+        G_host_try_context = __try.previous;                                   \
+    }
+
+#define END_TRY                                                                \
+    if (__try.ex != 0) {                                                       \
+        THROW(__try.ex);                                                       \
+    }                                                                          \
+    }
+
+#ifdef HOST_PRINTF
+#define PRINTF(...) fprintf(stderr, __VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+#define UNUSED(x) (void) (x)
+#define PIC(x) (x)
+
+#define os_memset memset
+#define os_memmove memmove
+#define os_memcmp memcmp
+
+#endif // __HOST_OS_H__
@@ -0,0 +1,268 @@
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <stdlib.h>
+#include "os.h"
+#include "cx.h"
+
+try_context_t *G_host_try_context;
+uint32_t G_host_cx_hash_calls;
+
+void os_longjmp(exception_t exception) {
+    if (G_host_try_context == NULL) {
+        fprintf(stderr, "uncaught exception 0x%04x\n", exception);
+        abort();
+    }
+    longjmp(G_host_try_context->jmp_buf, exception);
+}
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define ROL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static const uint32_t sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static void sha256Block(uint32_t *acc, const uint8_t *block) {
+    uint32_t w[64];
+    uint32_t a, b, c, d, e, f, g, h;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = ((uint32_t) block[i * 4] << 24) | ((uint32_t) block[i * 4 + 1] << 16) |
+               ((uint32_t) block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    }
+    for (i = 16; i < 64; i++) {
+        uint32_t s0 = ROR32(w[i - 15], 7) ^ ROR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROR32(w[i - 2], 17) ^ ROR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    a = acc[0]; b = acc[1]; c = acc[2]; d = acc[3];
+    e = acc[4]; f = acc[5]; g = acc[6]; h = acc[7];
+    for (i = 0; i < 64; i++) {
+        uint32_t t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+        uint32_t t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    acc[0] += a; acc[1] += b; acc[2] += c; acc[3] += d;
+    acc[4] += e; acc[5] += f; acc[6] += g; acc[7] += h;
+}
+
+static const uint8_t ripemdR[80] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+    3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+    1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+    4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13};
+static const uint8_t ripemdRp[80] = {
+    5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+    6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+    15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+    8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+    12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11};
+static const uint8_t ripemdS[80] = {
+    11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+    7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+    11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+    11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+    9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6};
+static const uint8_t ripemdSp[80] = {
+    8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+    9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+    9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+    15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+    8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11};
+static const uint32_t ripemdK[5] = {0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e};
+static const uint32_t ripemdKp[5] = {0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000};
+
+static uint32_t ripemdF(int j, uint32_t x, uint32_t y, uint32_t z) {
+    switch (j / 16) {
+    case 0: return x ^ y ^ z;
+    case 1: return (x & y) | (~x & z);
+    case 2: return (x | ~y) ^ z;
+    case 3: return (x & z) | (y & ~z);
+    default: return x ^ (y | ~z);
+    }
+}
+
+static void ripemd160Block(uint32_t *acc, const uint8_t *block) {
+    uint32_t x[16];
+    uint32_t al = acc[0], bl = acc[1], cl = acc[2], dl = acc[3], el = acc[4];
+    uint32_t ar = al, br = bl, cr = cl, dr = dl, er = el;
+    uint32_t t;
+    int j;
+
+    for (j = 0; j < 16; j++) {
+        x[j] = block[j * 4] | ((uint32_t) block[j * 4 + 1] << 8) |
+               ((uint32_t) block[j * 4 + 2] << 16) | ((uint32_t) block[j * 4 + 3] << 24);
+    }
+    for (j = 0; j < 80; j++) {
+        t = ROL32(al + ripemdF(j, bl, cl, dl) + x[ripemdR[j]] + ripemdK[j / 16], ripemdS[j]) + el;
+        al = el; el = dl; dl = ROL32(cl, 10); cl = bl; bl = t;
+        t = ROL32(ar + ripemdF(79 - j, br, cr, dr) + x[ripemdRp[j]] + ripemdKp[j / 16], ripemdSp[j]) + er;
+        ar = er; er = dr; dr = ROL32(cr, 10); cr = br; br = t;
+    }
+    t = acc[1] + cl + dr;
+    acc[1] = acc[2] + dl + er;
+    acc[2] = acc[3] + el + ar;
+    acc[3] = acc[4] + al + br;
+    acc[4] = acc[0] + bl + cr;
+    acc[0] = t;
+}
+
+int cx_sha256_init(cx_sha256_t *hash) {
+    static const uint32_t iv[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memset(hash, 0, sizeof(cx_sha256_t));
+    hash->header.algo = CX_SHA256;
+    memcpy(hash->acc, iv, sizeof(iv));
+    return CX_SHA256;
+}
+
+int cx_ripemd160_init(cx_ripemd160_t *hash) {
+    static const uint32_t iv[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    memset(hash, 0, sizeof(cx_ripemd160_t));
+    hash->header.algo = CX_RIPEMD160;
+    memcpy(hash->acc, iv, sizeof(iv));
+    return CX_RIPEMD160;
+}
+
+/**
+ * Both digests share the Merkle-Damgard framing, they differ in the block
+ * function and in the byte order of the length and of the result.
+*/
+int cx_hash(cx_hash_t *hash, int mode, const unsigned char *in, unsigned int len,
+            unsigned char *out, unsigned int out_len) {
+    uint32_t *blen;
+    uint8_t *block;
+    uint32_t *acc;
+    uint32_t words;
+    int bigEndian;
+    void (*blockFunction)(uint32_t *acc, const uint8_t *block);
+
+    G_host_cx_hash_calls++;
+
+    if (hash->algo == CX_SHA256) {
+        cx_sha256_t *sha = (cx_sha256_t *) hash;
+        blen = &sha->blen; block = sha->block; acc = sha->acc;
+        words = 8; bigEndian = 1; blockFunction = sha256Block;
+    } else if (hash->algo == CX_RIPEMD160) {
+        cx_ripemd160_t *ripemd = (cx_ripemd160_t *) hash;
+        blen = &ripemd->blen; block = ripemd->block; acc = ripemd->acc;
+        words = 5; bigEndian = 0; blockFunction = ripemd160Block;
+    } else {
+        THROW(INVALID_PARAMETER);
+    }
+
+    while (len > 0) {
+        uint32_t take = 64 - *blen < len ? 64 - *blen : len;
+        memcpy(block + *blen, in, take);
+        *blen += take;
+        in += take;
+        len -= take;
+        if (*blen == 64) {
+            blockFunction(acc, block);
+            hash->counter++;
+            *blen = 0;
+        }
+    }
+
+    if ((mode & CX_LAST) == 0) {
+        return 0;
+    }
+
+    uint64_t bits = ((uint64_t) hash->counter * 64 + *blen) * 8;
+    uint32_t i;
+    block[(*blen)++] = 0x80;
+    if (*blen > 56) {
+        memset(block + *blen, 0, 64 - *blen);
+        blockFunction(acc, block);
+        *blen = 0;
+    }
+    memset(block + *blen, 0, 56 - *blen);
+    for (i = 0; i < 8; i++) {
+        block[bigEndian ? 63 - i : 56 + i] = bits >> (8 * i);
+    }
+    blockFunction(acc, block);
+
+    if (out != NULL) {
+        if (out_len < words * 4) {
+            THROW(INVALID_PARAMETER);
+        }
+        for (i = 0; i < words * 4; i++) {
+            uint32_t shift = bigEndian ? 24 - 8 * (i % 4) : 8 * (i % 4);
+            out[i] = acc[i / 4] >> shift;
+        }
+    }
+    return words * 4;
+}
+
+int cx_hmac_sha256_init(cx_hmac_sha256_t *hmac, const unsigned char *key, unsigned int key_len) {
+    uint8_t pad[64];
+    uint32_t i;
+
+    memset(hmac->key, 0, sizeof(hmac->key));
+    if (key_len > sizeof(hmac->key)) {
+        cx_sha256_init(&hmac->hash);
+        cx_hash(&hmac->hash.header, CX_LAST, key, key_len, hmac->key, CX_SHA256_SIZE);
+    } else {
+        memcpy(hmac->key, key, key_len);
+    }
+
+    for (i = 0; i < sizeof(pad); i++) {
+        pad[i] = hmac->key[i] ^ 0x36;
+    }
+    cx_sha256_init(&hmac->hash);
+    cx_hash(&hmac->hash.header, 0, pad, sizeof(pad), NULL, 0);
+    return CX_SHA256;
+}
+
+int cx_hmac(cx_hmac_t *hmac, int mode, const unsigned char *in, unsigned int len,
+            unsigned char *mac, unsigned int mac_len) {
+    uint8_t inner[CX_SHA256_SIZE];
+    uint8_t pad[64];
+    uint32_t i;
+
+    cx_hash(&hmac->hash.header, 0, in, len, NULL, 0);
+    if ((mode & CX_LAST) == 0) {
+        return 0;
+    }
+
+    cx_hash(&hmac->hash.header, CX_LAST, NULL, 0, inner, sizeof(inner));
+    for (i = 0; i < sizeof(pad); i++) {
+        pad[i] = hmac->key[i] ^ 0x5c;
+    }
+    cx_sha256_init(&hmac->hash);
+    cx_hash(&hmac->hash.header, 0, pad, sizeof(pad), NULL, 0);
+    cx_hash(&hmac->hash.header, CX_LAST, inner, sizeof(inner), inner, sizeof(inner));
+
+    if (mac_len > sizeof(inner)) {
+        mac_len = sizeof(inner);
+    }
+    memcpy(mac, inner, mac_len);
+    // the SDK keeps the key, the next message restarts from the inner pad
+    cx_hmac_sha256_init(hmac, hmac->key, sizeof(hmac->key));
+    return CX_SHA256;
+}
@@ -0,0 +1,310 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Signs a batch of transactions on every available device at once.
+#
+# Devices are every Ledger found on USB HID plus each --speculos host:port
+# (the APDU port of the emulator, 9999 by default). Speculos needs an
+# automation rule approving the review screens, a Ledger someone pressing
+# its buttons.
+#
+# Jobs are the JSON files of --txs signed with --path, or the lines of a
+# --jobs file:
+#   {"file": "txs/tx-transfer.json", "path": "48'/13'/0'/0'/0'", "device": "hid:0"}
+# "path" and "device" are optional. A job with a device only runs on that
+# device. Otherwise an idle device takes the oldest job, preferring one for
+# the path it signed last.
+#
+# A job failing with 0x6A80 or a transport error is retried, on any device,
+# up to --retries times. A device with --max-errors transport errors in a
+# row is dropped. Signatures are reported in job order.
+
+import argparse
+import binascii
+import glob
+import json
+import os
+import sys
+import threading
+import time
+# time.strptime imports it lazily, which is not thread safe in python 2
+import _strptime
+from hiveBase import Fault, Transaction
+
+LEDGER_VENDOR_ID = 0x2c97
+SW_INVALID_DATA = 0x6A80
+
+
+class Job:
+    def __init__(self, index, filename, path, device=None):
+        self.index = index
+        self.filename = filename
+        self.path = path
+        self.device = device
+        self.attempts = 0
+        self.signature = None
+        self.error = None
+        self.signedBy = None
+        self.seconds = 0.0
+
+    def report(self):
+        return {
+            "index": self.index,
+            "file": self.filename,
+            "path": self.path,
+            "device": self.signedBy,
+            "attempts": self.attempts,
+            "seconds": round(self.seconds, 4),
+            "signature": self.signature,
+            "error": self.error,
+        }
+
+
+class Device:
+    def __init__(self, name, opener):
+        self.name = name
+        self.opener = opener
+        self.dongle = None
+        self.lastPath = None
+        self.jobs = 0
+        self.errors = 0
+        self.busySeconds = 0.0
+        self.dropped = False
+
+    def exchange(self, apdu):
+        if self.dongle is None:
+            self.dongle = self.opener()
+        return self.dongle.exchange(bytes(apdu))
+
+    def reset(self):
+        # reopened on the next job, a transport error may leave the channel unusable
+        if self.dongle is not None:
+            try:
+                self.dongle.close()
+            except Exception:
+                pass
+        self.dongle = None
+
+    def report(self):
+        return {
+            "device": self.name,
+            "jobs": self.jobs,
+            "errors": self.errors,
+            "busy_seconds": round(self.busySeconds, 4),
+            "dropped": self.dropped,
+        }
+
+
+def hid_devices():
+    try:
+        import hid
+        from ledgerblue.comm import HIDDongleHIDAPI
+    except ImportError:
+        return []
+
+    def opener(path):
+        def open_device():
+            device = hid.device()
+            device.open_path(path)
+            device.set_nonblocking(True)
+            return HIDDongleHIDAPI(device, True, False)
+        return open_device
+
+    devices = []
+    for info in hid.enumerate(LEDGER_VENDOR_ID, 0):
+        # same interface selection as ledgerblue getDongle()
+        if info.get('interface_number') == 0 or info.get('usage_page') == 0xffa0:
+            name = "hid:" + (info.get('serial_number') or str(len(devices)))
+            devices.append(Device(name, opener(info['path'])))
+    return devices
+
+
+def speculos_device(address):
+    from ledgerblue.commTCP import getDongle as getTCPDongle
+    host, _, port = address.rpartition(':')
+    host = host or "127.0.0.1"
+    return Device("speculos:%s:%s" % (host, port), lambda: getTCPDongle(host, int(port), False))
+
+
+def status_word(error):
+    return getattr(error, 'sw', None)
+
+
+class Coordinator:
+    def __init__(self, devices, jobs, retries, maxErrors):
+        self.devices = devices
+        self.jobs = jobs
+        self.pending = [job for job in jobs if job.error is None]
+        self.inFlight = 0
+        self.retries = retries
+        self.maxErrors = maxErrors
+        self.condition = threading.Condition()
+
+    def next_job(self, device):
+        """ Blocks until a job for device is pending, None once every job is done
+        """
+        with self.condition:
+            while True:
+                if device.dropped:
+                    return None
+                eligible = [job for job in self.pending if job.device in (None, device.name)]
+                if eligible:
+                    preferred = [job for job in eligible if job.path == device.lastPath]
+                    job = (preferred or eligible)[0]
+                    self.pending.remove(job)
+                    self.inFlight += 1
+                    return job
+                if not self.pending and self.inFlight == 0:
+                    return None
+                self.condition.wait(0.5)
+
+    def finish(self, device, job, error, retry):
+        with self.condition:
+            self.inFlight -= 1
+            if error is not None and retry and job.attempts <= self.retries:
+                self.pending.insert(0, job)
+            else:
+                job.error = error
+            if device.dropped:
+                # jobs nobody else is allowed to run
+                for pinned in [job for job in self.pending if job.device == device.name]:
+                    self.pending.remove(pinned)
+                    pinned.error = "device %s dropped" % device.name
+            self.condition.notify_all()
+
+    def sign(self, device, tx, path):
+        result = None
+        for apdu in tx.apdus(path):
+            result = device.exchange(apdu)
+        return binascii.hexlify(bytes(result))
+
+    def worker(self, device):
+        consecutiveErrors = 0
+        while True:
+            job = self.next_job(device)
+            if job is None:
+                return
+            job.attempts += 1
+            try:
+                with open(job.filename) as f:
+                    tx = Transaction.parse(json.load(f), verbose=False)
+            except Exception as e:
+                self.finish(device, job, "%s: %s" % (job.filename, e), False)
+                continue
+            start = time.time()
+            error = None
+            retry = False
+            try:
+                job.signature = self.sign(device, tx, job.path)
+                job.signedBy = device.name
+                device.lastPath = job.path
+                device.jobs += 1
+                consecutiveErrors = 0
+            except Exception as e:
+                sw = status_word(e)
+                device.errors += 1
+                if sw is None:
+                    error = "%s: %s" % (device.name, e)
+                    device.reset()
+                    retry = True
+                    consecutiveErrors += 1
+                    if consecutiveErrors >= self.maxErrors:
+                        device.dropped = True
+                else:
+                    # the device answered, the channel is fine
+                    error = "%s: %s" % (device.name, Fault.describe(sw, getattr(e, 'data', None)))
+                    retry = sw == SW_INVALID_DATA
+            elapsed = time.time() - start
+            job.seconds += elapsed
+            device.busySeconds += elapsed
+            self.finish(device, job, error, retry)
+
+    def run(self):
+        threads = [threading.Thread(target=self.worker, args=(device,)) for device in self.devices]
+        for thread in threads:
+            thread.daemon = True
+            thread.start()
+        for thread in threads:
+            while thread.is_alive():
+                thread.join(0.5)
+        for job in self.pending:
+            job.error = job.error or "no device left"
+
+
+def load_jobs(args):
+    jobs = []
+    if args.jobs is not None:
+        with open(args.jobs) as f:
+            for line in f:
+                if not line.strip():
+                    continue
+                entry = json.loads(line)
+                jobs.append(Job(len(jobs), entry['file'], entry.get('path', args.path), entry.get('device')))
+    else:
+        for filename in sorted(glob.glob(os.path.join(args.txs, '*.json'))):
+            jobs.append(Job(len(jobs), filename, args.path))
+    return jobs
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--txs', help="Directory with transactions in JSON format")
+parser.add_argument('--jobs', help="Job file, one JSON object per line")
+parser.add_argument('--path', help="BIP 32 path of jobs without one")
+parser.add_argument('--speculos', action='append', default=[], help="Speculos APDU port as host:port, repeatable")
+parser.add_argument('--no-hid', action='store_true', help="Do not look for USB devices")
+parser.add_argument('--retries', type=int, default=2, help="Retries of a job after 0x6A80 or a transport error")
+parser.add_argument('--max-errors', type=int, default=3, help="Consecutive transport errors before a device is dropped")
+parser.add_argument('--output', help="Write the JSON report here instead of stdout")
+args = parser.parse_args()
+
+if args.txs is None:
+    args.txs = 'txs'
+if args.path is None:
+    args.path = "48'/13'/0'/0'/0'"
+
+devices = [] if args.no_hid else hid_devices()
+devices += [speculos_device(address) for address in args.speculos]
+if not devices:
+    sys.exit("no device found")
+
+jobs = load_jobs(args)
+names = [device.name for device in devices]
+for job in jobs:
+    if job.device is not None and job.device not in names:
+        job.error = "device %s not found" % job.device
+coordinator = Coordinator(devices, jobs, args.retries, args.max_errors)
+start = time.time()
+coordinator.run()
+wall = time.time() - start
+
+signed = len([job for job in jobs if job.signature is not None])
+report = {
+    "wall_seconds": round(wall, 4),
+    "signed": signed,
+    "failed": len(jobs) - signed,
+    "jobs_per_second": round(signed / wall, 3) if wall > 0 else None,
+    "devices": [device.report() for device in devices],
+    "jobs": [job.report() for job in jobs],
+}
+output = json.dumps(report, indent=2, sort_keys=True)
+if args.output is None:
+    print output
+else:
+    with open(args.output, 'w') as f:
+        f.write(output + "\n")
@@ -0,0 +1,276 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Local signing daemon keeping one device connection open.
+#
+#   POST /sign    body: a transaction as in test/txs/, or
+#                 {"transaction": {...}, "path": "48'/13'/0'/0'/0'"}
+#                 reply: {"signature", "digest", "queue_ms", "sign_ms"}
+#   GET  /status  device state, queue depth and job latencies
+#
+# Requests are queued and signed one at a time on the device. The first
+# Ledger on USB is used, or the Speculos APDU port given with --speculos:
+#
+#   speculos.py bin/app.elf --display headless --automation file:approve.json &
+#   python signDaemon.py --speculos 127.0.0.1:9999 &
+#   curl -H 'Content-Type: application/json' -d @txs/tx-transfer.json http://127.0.0.1:8300/sign
+#
+# Errors: 400 for a transaction hiveBase cannot encode, 502 with the status
+# word when the device refuses it, 503 when the device is unreachable.
+# Web pages must not reach the device: a request with an Origin header gets
+# 403, one that is not application/json gets 415. A browser cannot send that
+# content type to another origin without a preflight, which is not answered.
+
+import argparse
+import binascii
+import collections
+import json
+import Queue
+import threading
+import time
+from BaseHTTPServer import BaseHTTPRequestHandler, HTTPServer
+from SocketServer import ThreadingMixIn
+# time.strptime imports it lazily, which is not thread safe in python 2
+import _strptime
+from hiveBase import Fault, Transaction
+
+LATENCY_WINDOW = 1000
+
+
+class DeviceUnavailable(Exception):
+    pass
+
+
+class Job:
+    def __init__(self, tx, path):
+        self.tx = tx
+        self.path = path
+        self.queued = time.time()
+        self.started = None
+        self.finished = None
+        self.signature = None
+        self.status = None
+        self.error = None
+        self.done = threading.Event()
+
+
+class Signer:
+    """ Owns the device connection, jobs are signed in arrival order by one thread
+    """
+    def __init__(self, opener, name):
+        self.opener = opener
+        self.name = name
+        self.dongle = None
+        self.state = "disconnected"
+        self.queue = Queue.Queue()
+        self.lock = threading.Lock()
+        self.signed = 0
+        self.failed = 0
+        self.latencies = collections.deque(maxlen=LATENCY_WINDOW)
+        self.started = time.time()
+        self.lastError = None
+
+    def submit(self, tx, path):
+        job = Job(tx, path)
+        self.queue.put(job)
+        return job
+
+    def connect(self):
+        if self.dongle is None:
+            try:
+                self.dongle = self.opener()
+            except Exception as e:
+                raise DeviceUnavailable(str(e))
+        return self.dongle
+
+    def disconnect(self):
+        if self.dongle is not None:
+            try:
+                self.dongle.close()
+            except Exception:
+                pass
+        self.dongle = None
+        self.state = "disconnected"
+
+    def sign(self, job):
+        dongle = self.connect()
+        self.state = "busy"
+        result = None
+        for apdu in job.tx.apdus(job.path):
+            result = dongle.exchange(bytes(apdu))
+        return binascii.hexlify(bytes(result))
+
+    def run(self):
+        try:
+            self.connect()
+            self.state = "idle"
+        except DeviceUnavailable:
+            pass
+        while True:
+            job = self.queue.get()
+            job.started = time.time()
+            try:
+                job.signature = self.sign(job)
+                self.state = "idle"
+            except DeviceUnavailable as e:
+                job.status = 503
+                job.error = "device unavailable: %s" % e
+            except Exception as e:
+                sw = getattr(e, 'sw', None)
+                if sw is None:
+                    # transport error, reopen on the next job
+                    self.disconnect()
+                    job.status = 503
+                    job.error = "transport error: %s" % e
+                else:
+                    self.state = "idle"
+                    job.status = 502
+                    job.error = Fault.describe(sw, getattr(e, 'data', None))
+            job.finished = time.time()
+            with self.lock:
+                if job.error is None:
+                    self.signed += 1
+                    self.latencies.append((job.started - job.queued, job.finished - job.started))
+                else:
+                    self.failed += 1
+                    self.lastError = job.error
+            job.done.set()
+
+    def status(self):
+        with self.lock:
+            latencies = list(self.latencies)
+            report = {
+                "device": self.name,
+                "state": self.state,
+                "queue_depth": self.queue.qsize(),
+                "signed": self.signed,
+                "failed": self.failed,
+                "last_error": self.lastError,
+                "uptime_seconds": round(time.time() - self.started, 1),
+            }
+        report["queue_ms"] = summary([queued for queued, signing in latencies])
+        report["sign_ms"] = summary([signing for queued, signing in latencies])
+        return report
+
+
+def summary(values):
+    """ Milliseconds over the last LATENCY_WINDOW jobs
+    """
+    if not values:
+        return None
+    values = sorted(values)
+    def at(fraction):
+        return round(values[min(len(values) - 1, int(fraction * len(values)))] * 1000, 2)
+    return {
+        "count": len(values),
+        "mean": round(sum(values) / len(values) * 1000, 2),
+        "p50": at(0.50),
+        "p95": at(0.95),
+        "max": at(1.0),
+    }
+
+
+class Handler(BaseHTTPRequestHandler):
+    def reply(self, code, body):
+        data = json.dumps(body, indent=2, sort_keys=True) + "\n"
+        self.send_response(code)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def do_GET(self):
+        if self.path != "/status":
+            return self.reply(404, {"error": "not found"})
+        self.reply(200, self.server.signer.status())
+
+    def do_POST(self):
+        if self.path != "/sign":
+            return self.reply(404, {"error": "not found"})
+        if self.headers.getheader('origin') is not None:
+            return self.reply(403, {"error": "cross-origin requests are refused"})
+        contentType = self.headers.getheader('content-type', '').split(';')[0].strip().lower()
+        if contentType != "application/json":
+            return self.reply(415, {"error": "content type must be application/json"})
+        try:
+            body = json.loads(self.rfile.read(int(self.headers.getheader('content-length', 0))))
+            path = self.server.path
+            if "transaction" in body:
+                path = body.get("path", path)
+                body = body["transaction"]
+            tx = Transaction.parse(body, verbose=False)
+            digest = tx.digest()
+        except Exception as e:
+            return self.reply(400, {"error": "invalid transaction: %s" % e})
+
+        job = self.server.signer.submit(tx, path)
+        job.done.wait()
+        if job.error is not None:
+            return self.reply(job.status, {"error": job.error})
+        self.reply(200, {
+            "signature": job.signature,
+            "digest": digest,
+            "queue_ms": round((job.started - job.queued) * 1000, 2),
+            "sign_ms": round((job.finished - job.started) * 1000, 2),
+        })
+
+    def log_message(self, format, *args):
+        if self.server.verbose:
+            BaseHTTPRequestHandler.log_message(self, format, *args)
+
+
+class Server(ThreadingMixIn, HTTPServer):
+    daemon_threads = True
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--listen', help="Address to listen on, host:port")
+parser.add_argument('--path', help="BIP 32 path of requests without one")
+parser.add_argument('--speculos', help="Speculos APDU port as host:port instead of USB")
+parser.add_argument('--verbose', action='store_true', help="Log every request")
+args = parser.parse_args()
+
+if args.listen is None:
+    args.listen = "127.0.0.1:8300"
+if args.path is None:
+    args.path = "48'/13'/0'/0'/0'"
+
+if args.speculos is not None:
+    from ledgerblue.commTCP import getDongle as getTCPDongle
+    host, _, port = args.speculos.rpartition(':')
+    host = host or "127.0.0.1"
+    signer = Signer(lambda: getTCPDongle(host, int(port), False), "speculos:%s:%s" % (host, port))
+else:
+    from ledgerblue.comm import getDongle
+    signer = Signer(lambda: getDongle(False), "hid")
+
+worker = threading.Thread(target=signer.run)
+worker.daemon = True
+worker.start()
+
+host, _, port = args.listen.rpartition(':')
+server = Server((host or "127.0.0.1", int(port)), Handler)
+server.signer = signer
+server.path = args.path
+server.verbose = args.verbose
+print "signing daemon on %s, device %s" % (args.listen, signer.name)
+try:
+    server.serve_forever()
+except KeyboardInterrupt:
+    pass
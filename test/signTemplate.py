@@ -0,0 +1,68 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Signs transactions of the same shape through a template: the template is
+# built from all the given files and loaded once, then every transaction is
+# signed by sending the values of its holes only.
+#
+#   python signTemplate.py --slot 0 vote-1.json vote-2.json vote-3.json
+#
+# The bytes sent per transaction are printed next to what INS_SIGN needs.
+import argparse
+import binascii
+import json
+from hiveBase import Fault, Template, Transaction
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--path', help="BIP 32 path to retrieve")
+parser.add_argument('--slot', type=int, default=0, help="Template slot")
+parser.add_argument('files', nargs='+', help="Transactions in JSON format")
+args = parser.parse_args()
+
+if args.path is None:
+    args.path = "48'/13'/0'/0'/0'"
+
+txs = []
+for filename in args.files:
+    with open(filename) as f:
+        txs.append(Transaction.parse(json.load(f), verbose=False))
+
+template = Template.from_transactions(txs)
+for filename, tx in zip(args.files, txs):
+    # what the device will hash, checked before anything is sent
+    if template.rebuild(template.values(tx)) != list(tx.fields(wire=True)):
+        exit("%s: the template does not rebuild the transaction" % filename)
+
+dongle = getDongle(True)
+try:
+    loaded = 0
+    for apdu in template.apdus(args.slot):
+        dongle.exchange(bytes(apdu))
+        loaded += len(apdu)
+    print "template: %d bytes in slot %d" % (loaded, args.slot)
+    for filename, tx in zip(args.files, txs):
+        apdu = template.sign_apdu(tx, args.path, args.slot)
+        result = dongle.exchange(bytes(apdu))
+        full = sum(len(fullApdu) for fullApdu in tx.apdus(args.path))
+        print "%s: %d bytes instead of %d, digest %s" % (filename, len(apdu), full, tx.digest())
+        print binascii.hexlify(result)
+except CommException as e:
+    exit(Fault.describe(e.sw, e.data))
@@ -20,28 +20,25 @@
 
 import binascii
 import json
+import random
 import struct
-from hiveBase import Transaction
+import time
+from hiveBase import Fault, Transaction
 from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
 import argparse
 
-def parse_bip32_path(path):
-    if len(path) == 0:
-        return ""
-    result = ""
-    elements = path.split('/')
-    for pathElement in elements:
-        element = pathElement.split('\'')
-        if len(element) == 1:
-            result = result + struct.pack(">I", int(element[0]))
-        else:
-            result = result + struct.pack(">I", 0x80000000 | int(element[0]))
-    return result
-
-
 parser = argparse.ArgumentParser()
 parser.add_argument('--path', help="BIP 32 path to retrieve")
 parser.add_argument('--file', help="Transaction in JSON format")
+parser.add_argument('--network', choices=sorted(Transaction.NETWORKS),
+                    help="Sign for a known network, its selector is sent instead of the chain id")
+parser.add_argument('--txid', action='store_true',
+                    help="Also return the transaction id and the signed digest")
+parser.add_argument('--retry', action='store_true',
+                    help="Get the signature given before for this transaction, without reviewing it")
+parser.add_argument('--resumable', action='store_true',
+                    help="Reconnect and resume the session when the transport is lost")
 args = parser.parse_args()
 
 if args.path is None:
@@ -50,37 +47,54 @@ if args.path is None:
 if args.file is None:
     args.file = 'txs/tx-commentoptions.json'
 
-donglePath = parse_bip32_path(args.path)
-pathSize = len(donglePath) / 4
-
 with file(args.file) as f:
     obj = json.load(f)
-    tx = Transaction.parse(obj)
-    tx_raw = tx.encode()
-    signData = tx_raw
-
-    dongle = getDongle(True)
-    offset = 0
-    first = True
-    singSize = len(signData)
-    while offset != singSize:
-        if singSize - offset > 200:
-            chunk = signData[offset: offset + 200]
-        else:
-            chunk = signData[offset:]
+    tx = Transaction.parse(obj, network=args.network)
+    print 'Signing digest ' + tx.digest()
 
-        if first:
-            print("LENGTH DONGLE")
-            totalSize = len(donglePath) + 1 + len(chunk)
-            print(binascii.hexlify(chunk))
-            apdu = "D4040000".decode('hex') + chr(totalSize) + chr(pathSize) + donglePath + chunk
-            first = False
-        else:
-            totalSize = len(chunk)
-            apdu = "D4048000".decode('hex') + chr(totalSize) + chunk
 
-        offset += len(chunk)
+def stream(dongle, apdus):
+    result = None
+    for apdu in apdus:
         result = dongle.exchange(bytes(apdu))
-        # print binascii.hexlify(result)
+    return result
+
+
+def resume(token):
+    """ Reconnects until the session of token is signed, sending what the
+    device did not get
+    """
+    while True:
+        time.sleep(1)
+        try:
+            dongle = getDongle(True)
+            status = dongle.exchange(bytes(Transaction.resume_apdu(token)))
+            if status[0] == Transaction.RESUME_SIGNED:
+                return status[1:]
+            if status[0] == Transaction.RESUME_SEND:
+                offset, = struct.unpack(">I", str(status[1:5]))
+                print "resuming at byte %d" % offset
+                return stream(dongle, tx.apdus_from(offset))
+        except (IOError, OSError) as e:
+            print "transport lost: %s" % e
+
+
+flags = (0x01 if args.txid else 0x00) | (0x02 if args.retry else 0x00)
+token = random.getrandbits(32) if args.resumable else None
+try:
+    try:
+        result = stream(getDongle(True), tx.apdus(args.path, flags=flags, token=token))
+    except (IOError, OSError) as e:
+        if token is None:
+            raise
+        print "transport lost: %s" % e
+        result = resume(token)
+except CommException as e:
+    exit(Fault.describe(e.sw, e.data))
 
-print(binascii.hexlify(result))
+print(binascii.hexlify(result[:65]))
+if args.txid and len(result) > 65:
+    txId = binascii.hexlify(result[65:85])
+    digest = binascii.hexlify(result[85:117])
+    print "transaction id %s%s" % (txId, "" if txId == tx.tx_id() else ", expected " + tx.tx_id())
+    print "signed digest %s%s" % (digest, "" if digest == tx.digest() else ", expected " + tx.digest())
@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Speculos emulator driven over its REST API, shared by the tools that run
+# the app without a device.
+import binascii
+import json
+import struct
+import threading
+import time
+import urllib2
+
+# Review screens on the Nano X end with one of these, approve with both buttons
+CONFIRM_TEXTS = ["Sign", "Accept", "Approve"]
+
+
+class Speculos:
+    def __init__(self, url):
+        self.url = url.rstrip('/')
+
+    def request(self, path, data=None):
+        if data is not None:
+            data = json.dumps(data)
+        req = urllib2.Request(self.url + path, data, {"Content-Type": "application/json"})
+        return json.loads(urllib2.urlopen(req).read())
+
+    def exchange(self, apdu):
+        reply = binascii.unhexlify(self.request("/apdu", {"data": binascii.hexlify(apdu)})["data"])
+        return reply[:-2], struct.unpack(">H", reply[-2:])[0]
+
+    def press(self, button):
+        self.request("/button/" + button, {"action": "press-and-release"})
+
+    def screen(self):
+        events = self.request("/events?currentscreenonly=true")["events"]
+        return " ".join(event.get("text", "") for event in events)
+
+    def wait_ready(self, timeout):
+        deadline = time.time() + timeout
+        while True:
+            try:
+                self.screen()
+                return
+            except Exception:
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.2)
+
+
+class Approver(threading.Thread):
+    """Approves review screens while an APDU is outstanding."""
+
+    def __init__(self, speculos, model, delay):
+        threading.Thread.__init__(self)
+        self.daemon = True
+        self.speculos = speculos
+        self.model = model
+        self.delay = delay
+        self.active = threading.Event()
+        self.presses = 0
+
+    def run(self):
+        while True:
+            self.active.wait()
+            time.sleep(self.delay)
+            if not self.active.is_set():
+                continue
+            try:
+                if self.model == "nanos":
+                    # Right button accepts the current review
+                    self.speculos.press("right")
+                elif any(text in self.speculos.screen() for text in CONFIRM_TEXTS):
+                    self.speculos.press("both")
+                else:
+                    self.speculos.press("right")
+                self.presses += 1
+            except Exception:
+                pass
@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+"""
+/*******************************************************************************
+*   Taras Shchybovyk
+*   (c) 2020 Andrew Chaney
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+"""
+# Checks what the device shows for operations whose decoding was fixed, with
+# the host build of the parser (make check-render in host/). Only the screens
+# listed are compared, each must be shown once. The others may change without
+# breaking the test.
+import json
+import os
+import sys
+from hiveBase import Transaction
+from hiveParser import HostParser, ParserFault
+
+TXS = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'txs')
+
+# file in txs/: operation name, screens it must show
+CASES = [
+    # Expiration follows the Fill or Kill byte
+    ('tx-limitordercreate.json', 'limit_order_create', [
+        ('Fill or Kill', 'true'),
+        ('Expiration', '1470659057'),
+    ]),
+    # percent is a uint16 on the chain
+    ('tx-setwithdrawvestingroute.json', 'set_withdraw_vesting_route', [
+        ('Percent', '9999'),
+    ]),
+    # the authorities follow the new account name, account auths
+    # are A1, A2... in every authority
+    ('tx-accountcreate.json', 'account_create', [
+        ('New Account Name', 'netuoso2'),
+        ('Owner Auth', 'Weight: 1 - K1 - STM7QtTRvd1owAh4uGaC6trxjR9M1cpqfi2WfLQed1GbUGPomt9DP:1 || '),
+        ('Active Auth', 'Weight: 1 - A1 - nettybot:1 || K1 - STM7QtTRvd1owAh4uGaC6trxjR9M1cpqfi2WfLQed1GbUGPomt9DP:1 || '),
+        ('Memo Key', 'STM7QtTRvd1owAh4uGaC6trxjR9M1cpqfi2WfLQed1GbUGPomt9DP'),
+        ('JSON Metadata', '{}'),
+    ]),
+    # the authorities follow the account name, JSON Metadata is the sixth
+    # and last screen
+    ('tx-accountupdate.json', 'account_update', [
+        ('Account', 'netuoso2'),
+        ('Owner Auth', 'Weight: 1 - K1 - STM7QtTRvd1owAh4uGaC6trxjR9M1cpqfi2WfLQed1GbUGPomt9DP:1 || '),
+        ('Active Auth', 'Weight: 1 - A1 - nettybot:1 || K1 - STM7QtTRvd1owAh4uGaC6trxjR9M1cpqfi2WfLQed1GbUGPomt9DP:1 || '),
+        ('Memo Key', 'STM7QtTRvd1owAh4uGaC6trxjR9M1cpqfi2WfLQed1GbUGPomt9DP'),
+        ('JSON Metadata', '{}'),
+    ]),
+    # account auths are A1, A2... as in account_create
+    ('tx-createclaimedaccount.json', 'create_claimed_account', [
+        ('Active Auth', 'Weight: 1 - A1 - nettybot:1 || K1 - STM7QtTRvd1owAh4uGaC6trxjR9M1cpqfi2WfLQed1GbUGPomt9DP:1 || '),
+    ]),
+    # no extensions is a single varint 0, as Hive encodes it
+    ('tx-commentoptionsnoextensions.json', 'comment_options', [
+        ('Beneficiaries', '[]'),
+    ]),
+    # the new reset account is part of the operation
+    ('tx-setresetaccount.json', 'set_reset_account', [
+        ('Cur Reset Account', 'nettybot'),
+        ('New Reset Account', 'netuoso2'),
+    ]),
+    # each auth list has its own label, an empty one included
+    ('tx-customjson.json', 'custom_json', [
+        ('Required Auths', '[  ]'),
+        ('Required Posting Auths', '[ netuoso ]'),
+    ]),
+]
+
+# file in txs/: digest Hive computes, for encodings hiveBase got wrong before
+DIGESTS = {
+    'tx-commentoptionsnoextensions.json': '922ec01e27b591b7200fc7efdd6e97db02007e93a4b1dcd84eba13fe349e7699',
+}
+
+
+def check(hostParser, filename, name, screens):
+    with open(os.path.join(TXS, filename)) as f:
+        tx = Transaction.parse(json.load(f), verbose=False)
+    try:
+        operations, digest = hostParser.run(tx)
+    except ParserFault as e:
+        return ["refused, %s" % e]
+    expected = DIGESTS.get(filename, tx.digest())
+    if digest != expected:
+        return ["digest %s, expected %s" % (digest, expected)]
+    if operations[0][0] != name:
+        return ["operation %s, expected %s" % (operations[0][0], name)]
+    shown = dict(operations[0][1])
+    labels = [label for label, _ in operations[0][1]]
+    errors = ["%s: %r, expected %r" % (label, shown.get(label), value)
+              for label, value in screens if shown.get(label) != value]
+    errors += ["%s: shown %d times" % (label, labels.count(label))
+               for label, _ in screens if labels.count(label) > 1]
+    return errors
+
+
+if __name__ == '__main__':
+    hostParser = HostParser()
+    failures = 0
+    for filename, name, screens in CASES:
+        errors = check(hostParser, filename, name, screens)
+        for error in errors:
+            print "%s: %s" % (filename, error)
+        failures += 1 if errors else 0
+    print "%d cases, %d failures" % (len(CASES), failures)
+    sys.exit(1 if failures else 0)